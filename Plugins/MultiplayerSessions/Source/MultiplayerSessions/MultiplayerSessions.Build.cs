@@ -41,6 +41,7 @@ public class MultiplayerSessions : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Icmp",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
@@ -9,6 +9,12 @@
 
 void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FString LobbyPath)
 {
+	// A dedicated server hosts from the lobby game mode and has nobody to show the menu to
+	if (IsRunningDedicatedServer())
+	{
+		return;
+	}
+
 	PathToLobby = FString::Printf(TEXT("%s?listen"), *LobbyPath);
 	NumPublicConnections = NumberOfPublicConnections;
 	MatchType = TypeOfMatch;
@@ -40,6 +46,7 @@ void UMenu::MenuSetup(int32 NumberOfPublicConnections, FString TypeOfMatch, FStr
 	{
 		MultiplayerSessionsSubsystem->MultiplayerOnCreateSessionComplete.AddDynamic(this, &ThisClass::OnCreateSession);
 		MultiplayerSessionsSubsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &ThisClass::OnFindSessions);
+		MultiplayerSessionsSubsystem->MultiplayerOnBestSessionsFound.AddUObject(this, &ThisClass::OnBestSessionsFound);
 		MultiplayerSessionsSubsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &ThisClass::OnJoinSession);
 		MultiplayerSessionsSubsystem->MultiplayerOnDestroySessionComplete.AddDynamic(this, &ThisClass::OnDestroySession);
 		MultiplayerSessionsSubsystem->MultiplayerOnStartSessionComplete.AddDynamic(this, &ThisClass::OnStartSession);
@@ -103,20 +110,29 @@ void UMenu::OnFindSessions(const TArray<FOnlineSessionSearchResult>& SessionResu
 		return;
 	}
 
-	for (auto Result : SessionResults)
+	// Results are already filtered by match type, so pick the one with the lowest ping
+	if (bWasSuccessful && SessionResults.Num() > 0)
 	{
-		FString SettingsValue;
-		Result.Session.SessionSettings.Get(FName("MatchType"), SettingsValue);
-		if (SettingsValue == MatchType)
-		{
-			MultiplayerSessionsSubsystem->JoinSession(Result);
-			return;
-		}
+		MultiplayerSessionsSubsystem->FindBestSessions(1);
+		return;
 	}
-	if (!bWasSuccessful || SessionResults.Num() == 0)
+	JoinButton->SetIsEnabled(true);
+}
+
+void UMenu::OnBestSessionsFound(const TArray<FOnlineSessionSearchResult>& BestSessions)
+{
+	if (MultiplayerSessionsSubsystem == nullptr || bJoiningSession)
 	{
-		JoinButton->SetIsEnabled(true);
+		return;
+	}
+
+	if (BestSessions.Num() > 0)
+	{
+		bJoiningSession = true;
+		MultiplayerSessionsSubsystem->JoinSession(BestSessions[0]);
+		return;
 	}
+	JoinButton->SetIsEnabled(true);
 }
 
 void UMenu::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
@@ -159,9 +175,10 @@ void UMenu::HostButtonClicked()
 void UMenu::JoinButtonClicked()
 {
 	JoinButton->SetIsEnabled(false);
+	bJoiningSession = false;
 	if (MultiplayerSessionsSubsystem)
 	{
-		MultiplayerSessionsSubsystem->FindSessions(10000);
+		MultiplayerSessionsSubsystem->FindSessions(10000, MatchType);
 	}
 }
 
@@ -5,6 +5,7 @@
 #include "OnlineSubsystem.h"
 #include "OnlineSessionSettings.h"
 #include "Online/OnlineSessionNames.h"
+#include "SessionPingProber.h"
 
 UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
 	CreateSessionCompleteDelegate(FOnCreateSessionCompleteDelegate::CreateUObject(this, &ThisClass::OnCreateSessionComplete)),
@@ -16,6 +17,29 @@ UMultiplayerSessionsSubsystem::UMultiplayerSessionsSubsystem():
 	
 }
 
+void UMultiplayerSessionsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	OperationQueueTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::TickOperationQueue), 0.1f);
+}
+
+void UMultiplayerSessionsSubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(OperationQueueTickerHandle);
+	OperationQueue.Reset();
+	bOperationInProgress = false;
+
+	StopSearchResultsStreaming();
+	if (PingProber.IsValid())
+	{
+		PingProber->Cancel();
+		PingProber.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
 void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FString MatchType)
 {
 	if (!IsValidSessionInterface())
@@ -23,61 +47,113 @@ void UMultiplayerSessionsSubsystem::CreateSession(int32 NumPublicConnections, FS
 		return;
 	}
 
-	auto ExistingSession = SessionInterface->GetNamedSession(NAME_GameSession);
-	if (ExistingSession != nullptr)
-	{
-		bCreateSessionOnDestroy = true;
-		LastNumPublicConnections = NumPublicConnections;
-		LastMatchType = MatchType;
+	HostStartTime = FPlatformTime::Seconds();
 
-		DestroySession();
-	}
+	// The queue destroys any existing session ahead of each attempt instead of racing it
+	EnqueueOperation(ESessionOperationType::Create,
+		[this, NumPublicConnections, MatchType]()
+		{
+			LastNumPublicConnections = NumPublicConnections;
+			LastMatchType = MatchType;
+			return BeginCreateSession();
+		},
+		[this](bool bWasSuccessful)
+		{
+			LastHostSeconds = FPlatformTime::Seconds() - HostStartTime;
+			UE_LOG(LogOnline, Log, TEXT("Hosting %s after %.3f s"), bWasSuccessful ? TEXT("succeeded") : TEXT("failed"), LastHostSeconds);
+			MultiplayerOnCreateSessionComplete.Broadcast(bWasSuccessful);
+		},
+		true);
+}
 
+bool UMultiplayerSessionsSubsystem::BeginCreateSession()
+{
 	// Store the delegate in a FDelegateHandle so we can later remove it from the delegate list
 	CreateSessionCompleteDelegateHandle = SessionInterface->AddOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegate);
 
 	LastSessionSettings = MakeShareable(new FOnlineSessionSettings());
 	LastSessionSettings->bIsLANMatch = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" ? true : false;
-	LastSessionSettings->NumPublicConnections = NumPublicConnections;
+	LastSessionSettings->NumPublicConnections = LastNumPublicConnections;
 	LastSessionSettings->bAllowJoinInProgress = true;
 	LastSessionSettings->bAllowJoinViaPresence = true;
 	LastSessionSettings->bShouldAdvertise = true;
 	LastSessionSettings->bUsesPresence = true;
 	LastSessionSettings->bUseLobbiesIfAvailable = true;
-	LastSessionSettings->Set(FName("MatchType"), MatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
+	LastSessionSettings->Set(FName("MatchType"), LastMatchType, EOnlineDataAdvertisementType::ViaOnlineServiceAndPing);
 	LastSessionSettings->BuildUniqueId = 1;
 
-	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings))
+	bool bCreated = false;
+	if (IsRunningDedicatedServer())
+	{
+		// A dedicated server has no local player to host with, and no presence or lobby to advertise through
+		LastSessionSettings->bIsDedicated = true;
+		LastSessionSettings->bUsesPresence = false;
+		LastSessionSettings->bAllowJoinViaPresence = false;
+		LastSessionSettings->bUseLobbiesIfAvailable = false;
+		bCreated = SessionInterface->CreateSession(0, NAME_GameSession, *LastSessionSettings);
+	}
+	else
+	{
+		const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
+		bCreated = LocalPlayer && SessionInterface->CreateSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, *LastSessionSettings);
+	}
+	if (!bCreated)
 	{
 		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
-
-		// Broadcast our own custom delegate
-		MultiplayerOnCreateSessionComplete.Broadcast(false);
+		return false;
 	}
+	return true;
 }
 
-void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults)
+void UMultiplayerSessionsSubsystem::FindSessions(int32 MaxSearchResults, const FString& MatchType)
 {
 	if (!IsValidSessionInterface())
 	{
 		return;
 	}
 
+	JoinStartTime = FPlatformTime::Seconds();
+
+	EnqueueOperation(ESessionOperationType::Find,
+		[this, MaxSearchResults, MatchType]()
+		{
+			LastMaxSearchResults = MaxSearchResults;
+			LastSearchMatchType = MatchType;
+			return BeginFindSessions();
+		},
+		[this](bool bWasSuccessful)
+		{
+			DeliverSearchResults(bWasSuccessful);
+		});
+}
+
+bool UMultiplayerSessionsSubsystem::BeginFindSessions()
+{
 	FindSessionsCompleteDelegateHandle = SessionInterface->AddOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegate);
 
 	LastSessionSearch = MakeShareable(new FOnlineSessionSearch());
-	LastSessionSearch->MaxSearchResults = MaxSearchResults;
+	LastSessionSearch->MaxSearchResults = LastMaxSearchResults;
 	LastSessionSearch->bIsLanQuery = IOnlineSubsystem::Get()->GetSubsystemName() == "NULL" ? true : false;
 	LastSessionSearch->QuerySettings.Set(SEARCH_PRESENCE, true, EOnlineComparisonOp::Equals);
+	if (!LastSearchMatchType.IsEmpty())
+	{
+		// Let the online service filter by match type instead of sending us every session
+		LastSessionSearch->QuerySettings.Set(FName("MatchType"), LastSearchMatchType, EOnlineComparisonOp::Equals);
+	}
+
+	// Results are handed out as the search finds them. Started before the search so a search that completes inside FindSessions stops it again
+	StopSearchResultsStreaming();
+	NextSearchResultIndex = 0;
+	SearchResultsTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::TickSearchResults));
 
 	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
 	if (!SessionInterface->FindSessions(*LocalPlayer->GetPreferredUniqueNetId(), LastSessionSearch.ToSharedRef()))
 	{
 		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
-
-		MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
+		StopSearchResultsStreaming();
+		return false;
 	}
+	return true;
 }
 
 void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult& SessionResult)
@@ -88,15 +164,117 @@ void UMultiplayerSessionsSubsystem::JoinSession(const FOnlineSessionSearchResult
 		return;
 	}
 
+	EnqueueOperation(ESessionOperationType::Join,
+		[this, SessionResult]()
+		{
+			LastJoinSessionResult = SessionResult;
+			return BeginJoinSession();
+		},
+		[this](bool bWasSuccessful)
+		{
+			LastJoinSeconds = FPlatformTime::Seconds() - JoinStartTime;
+			UE_LOG(LogOnline, Log, TEXT("Joining %s after %.3f s"), bWasSuccessful ? TEXT("succeeded") : TEXT("failed"), LastJoinSeconds);
+			if (!bWasSuccessful && LastJoinResult == EOnJoinSessionCompleteResult::Success)
+			{
+				LastJoinResult = EOnJoinSessionCompleteResult::UnknownError;
+			}
+			MultiplayerOnJoinSessionComplete.Broadcast(LastJoinResult);
+		},
+		true);
+}
+
+bool UMultiplayerSessionsSubsystem::BeginJoinSession()
+{
+	LastJoinResult = EOnJoinSessionCompleteResult::UnknownError;
 	JoinSessionCompleteDelegateHandle = SessionInterface->AddOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegate);
 
 	const ULocalPlayer* LocalPlayer = GetWorld()->GetFirstLocalPlayerFromController();
-	if (!SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, SessionResult))
+	if (!LastJoinSessionResult.IsSet() || !SessionInterface->JoinSession(*LocalPlayer->GetPreferredUniqueNetId(), NAME_GameSession, LastJoinSessionResult.GetValue()))
 	{
 		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+		return false;
+	}
+	return true;
+}
 
-		MultiplayerOnJoinSessionComplete.Broadcast(EOnJoinSessionCompleteResult::UnknownError);
+void UMultiplayerSessionsSubsystem::FindBestSessions(int32 BestCount)
+{
+	if (!IsValidSessionInterface() || !LastSessionSearch.IsValid())
+	{
+		BestSessions.Reset();
+		MultiplayerOnBestSessionsFound.Broadcast(BestSessions);
+		return;
 	}
+
+	if (!PingProber.IsValid())
+	{
+		PingProber = MakeShared<FSessionPingProber>();
+	}
+
+	const TArray<FOnlineSessionSearchResult>& SearchResults = LastSessionSearch->SearchResults;
+	TArray<FString> HostAddresses;
+	for (int32 Index = 0; Index < FMath::Min(SearchResults.Num(), MaxPingCandidates); ++Index)
+	{
+		const FString HostAddress = GetHostAddress(SearchResults[Index]);
+		if (!HostAddress.IsEmpty())
+		{
+			HostAddresses.Add(HostAddress);
+		}
+	}
+
+	// Probes run concurrently; cached hosts are not probed again
+	TWeakObjectPtr<UMultiplayerSessionsSubsystem> WeakThis(this);
+	PingProber->Probe(HostAddresses, [WeakThis, BestCount]()
+	{
+		if (WeakThis.IsValid())
+		{
+			WeakThis->OnPingProbesComplete(BestCount);
+		}
+	});
+}
+
+void UMultiplayerSessionsSubsystem::OnPingProbesComplete(int32 BestCount)
+{
+	BestSessions.Reset();
+	if (!LastSessionSearch.IsValid())
+	{
+		MultiplayerOnBestSessionsFound.Broadcast(BestSessions);
+		return;
+	}
+
+	// Use the measured ping, falling back to the ping reported by the online service
+	TArray<TPair<float, int32>> RankedResults;
+	const TArray<FOnlineSessionSearchResult>& SearchResults = LastSessionSearch->SearchResults;
+	for (int32 Index = 0; Index < FMath::Min(SearchResults.Num(), MaxPingCandidates); ++Index)
+	{
+		const TOptional<float> MeasuredPing = PingProber->GetCachedPing(GetHostAddress(SearchResults[Index]));
+		const float PingMs = MeasuredPing.IsSet() ? MeasuredPing.GetValue() : static_cast<float>(SearchResults[Index].PingInMs);
+		RankedResults.Emplace(PingMs, Index);
+	}
+	RankedResults.Sort([](const TPair<float, int32>& A, const TPair<float, int32>& B)
+	{
+		return A.Key < B.Key;
+	});
+
+	for (int32 Rank = 0; Rank < FMath::Min(BestCount, RankedResults.Num()); ++Rank)
+	{
+		UE_LOG(LogOnline, Verbose, TEXT("Session %s ranked %d with ping %.1f ms"), *SearchResults[RankedResults[Rank].Value].GetSessionIdStr(), Rank, RankedResults[Rank].Key);
+		BestSessions.Add(SearchResults[RankedResults[Rank].Value]);
+	}
+	MultiplayerOnBestSessionsFound.Broadcast(BestSessions);
+}
+
+FString UMultiplayerSessionsSubsystem::GetHostAddress(const FOnlineSessionSearchResult& SessionResult) const
+{
+	FString ConnectString;
+	if (!SessionInterface.IsValid() || !SessionInterface->GetResolvedConnectString(SessionResult, NAME_GamePort, ConnectString))
+	{
+		return FString();
+	}
+
+	// Strip the port, ICMP only needs the host
+	FString HostAddress;
+	return ConnectString.Split(TEXT(":"), &HostAddress, nullptr, ESearchCase::IgnoreCase, ESearchDir::FromEnd) ? HostAddress : ConnectString;
 }
 
 void UMultiplayerSessionsSubsystem::DestroySession()
@@ -107,17 +285,231 @@ void UMultiplayerSessionsSubsystem::DestroySession()
 		return;
 	}
 
+	EnqueueOperation(ESessionOperationType::Destroy,
+		[this]()
+		{
+			return BeginDestroySession();
+		},
+		[this](bool bWasSuccessful)
+		{
+			MultiplayerOnDestroySessionComplete.Broadcast(bWasSuccessful);
+		});
+}
+
+bool UMultiplayerSessionsSubsystem::BeginDestroySession()
+{
 	DestroySessionCompleteDelegateHandle = SessionInterface->AddOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegate);
 
 	if (!SessionInterface->DestroySession(NAME_GameSession))
 	{
 		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
-		MultiplayerOnDestroySessionComplete.Broadcast(false);
+		return false;
 	}
+	return true;
 }
 
 void UMultiplayerSessionsSubsystem::StartSession()
 {
+	if (!IsValidSessionInterface())
+	{
+		MultiplayerOnStartSessionComplete.Broadcast(false);
+		return;
+	}
+
+	EnqueueOperation(ESessionOperationType::Start,
+		[this]()
+		{
+			return BeginStartSession();
+		},
+		[this](bool bWasSuccessful)
+		{
+			MultiplayerOnStartSessionComplete.Broadcast(bWasSuccessful);
+		});
+}
+
+bool UMultiplayerSessionsSubsystem::BeginStartSession()
+{
+	StartSessionCompleteDelegateHandle = SessionInterface->AddOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegate);
+
+	if (!SessionInterface->StartSession(NAME_GameSession))
+	{
+		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+		return false;
+	}
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::EnqueueOperation(ESessionOperationType Type, TFunction<bool()> Begin, TFunction<void(bool)> Finish, bool bRequiresNoSession)
+{
+	FSessionOperation& Operation = OperationQueue.AddDefaulted_GetRef();
+	Operation.Type = Type;
+	Operation.Begin = MoveTemp(Begin);
+	Operation.Finish = MoveTemp(Finish);
+	Operation.Serial = ++NextOperationSerial;
+	Operation.QueuedTime = FPlatformTime::Seconds();
+	Operation.bRequiresNoSession = bRequiresNoSession;
+
+	BeginNextOperation();
+}
+
+void UMultiplayerSessionsSubsystem::BeginNextOperation()
+{
+	// An attempt that is beginning right now picks up the next operation once its Begin has returned
+	if (bBeginningAttempt)
+	{
+		return;
+	}
+
+	// Loop rather than recurse, since attempts can complete synchronously
+	while (!bOperationInProgress && OperationQueue.Num() > 0)
+	{
+		bOperationInProgress = true;
+		BeginOperationAttempt();
+	}
+}
+
+void UMultiplayerSessionsSubsystem::BeginOperationAttempt()
+{
+	FSessionOperation* Operation = &OperationQueue[0];
+	if (Operation->bRequiresNoSession && Operation->SessionDestroyedForAttempt != Operation->NumAttempts + 1 && HasGameSession())
+	{
+		// Creating or joining fails while NAME_GameSession exists, whether from an earlier session or a failed earlier attempt
+		Operation->SessionDestroyedForAttempt = Operation->NumAttempts + 1;
+
+		FSessionOperation DestroyOperation;
+		DestroyOperation.Type = ESessionOperationType::Destroy;
+		DestroyOperation.Begin = [this]() { return BeginDestroySession(); };
+		DestroyOperation.Serial = ++NextOperationSerial;
+		DestroyOperation.QueuedTime = FPlatformTime::Seconds();
+		OperationQueue.Insert(MoveTemp(DestroyOperation), 0);
+		Operation = &OperationQueue[0];
+	}
+
+	Operation->bWaitingToRetry = false;
+	Operation->NumAttempts++;
+	Operation->AttemptStartTime = FPlatformTime::Seconds();
+
+	// Begin may complete and pop the operation before it returns, so run a copy and don't touch the operation afterwards
+	const ESessionOperationType Type = Operation->Type;
+	const uint32 Serial = Operation->Serial;
+	const TFunction<bool()> Begin = Operation->Begin;
+
+	bBeginningAttempt = true;
+	if (!Begin() && IsCurrentOperation(Serial))
+	{
+		CompleteOperation(Type, false);
+	}
+	bBeginningAttempt = false;
+}
+
+bool UMultiplayerSessionsSubsystem::IsCurrentOperation(uint32 Serial) const
+{
+	return bOperationInProgress && OperationQueue.Num() > 0 && OperationQueue[0].Serial == Serial && !OperationQueue[0].bWaitingToRetry;
+}
+
+void UMultiplayerSessionsSubsystem::CompleteOperation(ESessionOperationType Type, bool bWasSuccessful, bool bCanRetry)
+{
+	// Ignore late results of attempts that already timed out
+	if (!bOperationInProgress || OperationQueue.Num() == 0 || OperationQueue[0].Type != Type || OperationQueue[0].bWaitingToRetry)
+	{
+		return;
+	}
+
+	FSessionOperation& Operation = OperationQueue[0];
+	FSessionOperationStats& Stats = OperationStats[static_cast<int32>(Type)];
+	if (!bWasSuccessful && bCanRetry && Operation.NumAttempts <= MaxOperationRetries)
+	{
+		Stats.NumRetries++;
+		Operation.bWaitingToRetry = true;
+		Operation.RetryTime = FPlatformTime::Seconds() + OperationRetryDelay;
+		return;
+	}
+
+	const double Seconds = FPlatformTime::Seconds() - Operation.QueuedTime;
+	Stats.LastSeconds = Seconds;
+	Stats.TotalSeconds += Seconds;
+	Stats.MaxSeconds = FMath::Max(Stats.MaxSeconds, Seconds);
+	bWasSuccessful ? Stats.NumSucceeded++ : Stats.NumFailed++;
+
+	// Pop before finishing so the finish callback can queue follow-up operations
+	TFunction<void(bool)> Finish = MoveTemp(Operation.Finish);
+	OperationQueue.RemoveAt(0);
+	bOperationInProgress = false;
+
+	if (Finish)
+	{
+		Finish(bWasSuccessful);
+	}
+	BeginNextOperation();
+}
+
+bool UMultiplayerSessionsSubsystem::TickOperationQueue(float DeltaTime)
+{
+	if (!bOperationInProgress || OperationQueue.Num() == 0)
+	{
+		return true;
+	}
+
+	FSessionOperation& Operation = OperationQueue[0];
+	const double Now = FPlatformTime::Seconds();
+	if (Operation.bWaitingToRetry)
+	{
+		if (Now >= Operation.RetryTime)
+		{
+			BeginOperationAttempt();
+			BeginNextOperation();
+		}
+	}
+	else if (Now - Operation.AttemptStartTime > OperationTimeout)
+	{
+		// Drop the timed out attempt's delegate so a late result can't complete the next attempt
+		OperationStats[static_cast<int32>(Operation.Type)].NumTimeouts++;
+		ClearOperationDelegate(Operation.Type);
+		CompleteOperation(Operation.Type, false);
+	}
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::ClearOperationDelegate(ESessionOperationType Type)
+{
+	if (!SessionInterface) return;
+
+	switch (Type)
+	{
+	case ESessionOperationType::Create:
+		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
+		break;
+	case ESessionOperationType::Find:
+		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
+		break;
+	case ESessionOperationType::Join:
+		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
+		break;
+	case ESessionOperationType::Destroy:
+		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
+		break;
+	case ESessionOperationType::Start:
+		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+		break;
+	default:
+		break;
+	}
+}
+
+void UMultiplayerSessionsSubsystem::LogOperationStats() const
+{
+	static const TCHAR* OperationNames[] = { TEXT("Create"), TEXT("Find"), TEXT("Join"), TEXT("Destroy"), TEXT("Start") };
+	static_assert(UE_ARRAY_COUNT(OperationNames) == static_cast<int32>(ESessionOperationType::Max), "Every session operation needs a name");
+
+	for (int32 Index = 0; Index < static_cast<int32>(ESessionOperationType::Max); ++Index)
+	{
+		const FSessionOperationStats& Stats = OperationStats[Index];
+		const int32 NumFinished = Stats.NumSucceeded + Stats.NumFailed;
+		UE_LOG(LogOnline, Display, TEXT("%-8s %3d ok %3d failed %3d retries %3d timeouts, last %.3f s, avg %.3f s, max %.3f s"),
+			OperationNames[Index], Stats.NumSucceeded, Stats.NumFailed, Stats.NumRetries, Stats.NumTimeouts,
+			Stats.LastSeconds, NumFinished > 0 ? Stats.TotalSeconds / NumFinished : 0.0, Stats.MaxSeconds);
+	}
+	UE_LOG(LogOnline, Display, TEXT("Last host %.3f s, last join %.3f s"), LastHostSeconds, LastJoinSeconds);
 }
 
 bool UMultiplayerSessionsSubsystem::IsValidSessionInterface()
@@ -133,6 +525,11 @@ bool UMultiplayerSessionsSubsystem::IsValidSessionInterface()
 	return SessionInterface.IsValid();
 }
 
+bool UMultiplayerSessionsSubsystem::HasGameSession()
+{
+	return IsValidSessionInterface() && SessionInterface->GetNamedSession(NAME_GameSession) != nullptr;
+}
+
 void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, bool bWasSuccessful)
 {
 	if (SessionInterface)
@@ -140,7 +537,7 @@ void UMultiplayerSessionsSubsystem::OnCreateSessionComplete(FName SessionName, b
 		SessionInterface->ClearOnCreateSessionCompleteDelegate_Handle(CreateSessionCompleteDelegateHandle);
 	}
 
-	MultiplayerOnCreateSessionComplete.Broadcast(bWasSuccessful);
+	CompleteOperation(ESessionOperationType::Create, bWasSuccessful);
 }
 
 void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
@@ -150,13 +547,73 @@ void UMultiplayerSessionsSubsystem::OnFindSessionsComplete(bool bWasSuccessful)
 		SessionInterface->ClearOnFindSessionsCompleteDelegate_Handle(FindSessionsCompleteDelegateHandle);
 	}
 
-	if (LastSessionSearch->SearchResults.Num() <= 0)
+	CompleteOperation(ESessionOperationType::Find, bWasSuccessful);
+}
+
+void UMultiplayerSessionsSubsystem::DeliverSearchResults(bool bWasSuccessful)
+{
+	StopSearchResultsStreaming();
+
+	if (!LastSessionSearch.IsValid())
 	{
+		MultiplayerOnFindSessionsPage.Broadcast(TConstArrayView<FOnlineSessionSearchResult>(), true);
 		MultiplayerOnFindSessionsComplete.Broadcast(TArray<FOnlineSessionSearchResult>(), false);
 		return;
 	}
 
-	MultiplayerOnFindSessionsComplete.Broadcast(LastSessionSearch->SearchResults, bWasSuccessful);
+	DeliverNewSearchResults(true);
+
+	const TArray<FOnlineSessionSearchResult>& SearchResults = LastSessionSearch->SearchResults;
+	MultiplayerOnFindSessionsComplete.Broadcast(SearchResults, bWasSuccessful && SearchResults.Num() > 0);
+}
+
+bool UMultiplayerSessionsSubsystem::TickSearchResults(float DeltaTime)
+{
+	if (!LastSessionSearch.IsValid())
+	{
+		SearchResultsTickerHandle.Reset();
+		return false;
+	}
+
+	DeliverNewSearchResults(false);
+	return true;
+}
+
+void UMultiplayerSessionsSubsystem::DeliverNewSearchResults(bool bIsLastPage)
+{
+	TArray<FOnlineSessionSearchResult>& SearchResults = LastSessionSearch->SearchResults;
+	if (SearchResults.Num() <= NextSearchResultIndex && !bIsLastPage)
+	{
+		return;
+	}
+
+	// LAN searches on the NULL subsystem ignore custom query settings, so filter what they return. Results already delivered all match,
+	// so this only removes new ones, and it keeps the order the online service returned them in
+	if (!LastSearchMatchType.IsEmpty() && LastSessionSearch->bIsLanQuery)
+	{
+		SearchResults.RemoveAll([this](const FOnlineSessionSearchResult& Result)
+		{
+			FString SettingsValue;
+			Result.Session.SessionSettings.Get(FName("MatchType"), SettingsValue);
+			return SettingsValue != LastSearchMatchType;
+		});
+	}
+
+	const int32 FirstIndex = FMath::Min(NextSearchResultIndex, SearchResults.Num());
+	NextSearchResultIndex = SearchResults.Num();
+	if (NextSearchResultIndex > FirstIndex || bIsLastPage)
+	{
+		MultiplayerOnFindSessionsPage.Broadcast(TConstArrayView<FOnlineSessionSearchResult>(SearchResults.GetData() + FirstIndex, NextSearchResultIndex - FirstIndex), bIsLastPage);
+	}
+}
+
+void UMultiplayerSessionsSubsystem::StopSearchResultsStreaming()
+{
+	if (SearchResultsTickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(SearchResultsTickerHandle);
+		SearchResultsTickerHandle.Reset();
+	}
 }
 
 void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOnJoinSessionCompleteResult::Type Result)
@@ -166,7 +623,10 @@ void UMultiplayerSessionsSubsystem::OnJoinSessionComplete(FName SessionName, EOn
 		SessionInterface->ClearOnJoinSessionCompleteDelegate_Handle(JoinSessionCompleteDelegateHandle);
 	}
 
-	MultiplayerOnJoinSessionComplete.Broadcast(Result);
+	// Only transient failures are worth another attempt
+	LastJoinResult = Result;
+	const bool bCanRetry = Result == EOnJoinSessionCompleteResult::UnknownError || Result == EOnJoinSessionCompleteResult::CouldNotRetrieveAddress;
+	CompleteOperation(ESessionOperationType::Join, Result == EOnJoinSessionCompleteResult::Success, bCanRetry);
 }
 
 void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName, bool bWasSuccessful)
@@ -175,14 +635,16 @@ void UMultiplayerSessionsSubsystem::OnDestroySessionComplete(FName SessionName,
 	{
 		SessionInterface->ClearOnDestroySessionCompleteDelegate_Handle(DestroySessionCompleteDelegateHandle);
 	}
-	if (bWasSuccessful && bCreateSessionOnDestroy)
-	{
-		bCreateSessionOnDestroy = false;
-		CreateSession(LastNumPublicConnections, LastMatchType);
-	}
-	MultiplayerOnDestroySessionComplete.Broadcast(bWasSuccessful);
+
+	CompleteOperation(ESessionOperationType::Destroy, bWasSuccessful);
 }
 
 void UMultiplayerSessionsSubsystem::OnStartSessionComplete(FName SessionName, bool bWasSuccessful)
 {
+	if (SessionInterface)
+	{
+		SessionInterface->ClearOnStartSessionCompleteDelegate_Handle(StartSessionCompleteDelegateHandle);
+	}
+
+	CompleteOperation(ESessionOperationType::Start, bWasSuccessful);
 }
@@ -0,0 +1,257 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "MultiplayerSessionsSubsystem.h"
+#include "SessionBenchmark.h"
+#include "OnlineSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/Paths.h"
+#include "UObject/StrongObjectPtr.h"
+
+//
+// Checks the order of the subsystem delegates against the NULL online subsystem on localhost. Run them in a game instance, e.g.
+//
+//   UnrealEditor Blaster.uproject -game -nullrhi -unattended -ini:Engine:[OnlineSubsystem]:DefaultPlatformService=NULL -ExecCmds="Automation RunTests MultiplayerSessions; Quit"
+//
+// HostAndJoin starts a second instance of the same executable to host the session it joins.
+//
+
+namespace MultiplayerSessionsTests
+{
+	// Long enough for a LAN search to see a session advertised by a process that is still starting up
+	constexpr double HostStartupTimeout = 60.0;
+	constexpr double RunTimeout = 30.0;
+	constexpr float HostHoldSeconds = 30.f;
+
+	UMultiplayerSessionsSubsystem* FindSubsystem(FAutomationTestBase& Test)
+	{
+		UGameInstance* GameInstance = nullptr;
+		for (const FWorldContext& WorldContext : GEngine->GetWorldContexts())
+		{
+			if ((WorldContext.WorldType == EWorldType::Game || WorldContext.WorldType == EWorldType::PIE) && WorldContext.OwningGameInstance)
+			{
+				GameInstance = WorldContext.OwningGameInstance;
+				break;
+			}
+		}
+
+		UMultiplayerSessionsSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+		if (Subsystem == nullptr)
+		{
+			Test.AddError(TEXT("No game instance to run in, start the tests with -game or from PIE"));
+			return nullptr;
+		}
+
+		const IOnlineSubsystem* OnlineSubsystem = IOnlineSubsystem::Get();
+		if (OnlineSubsystem == nullptr || OnlineSubsystem->GetSubsystemName() != NULL_SUBSYSTEM)
+		{
+			Test.AddError(TEXT("The session tests need the NULL online subsystem, pass -ini:Engine:[OnlineSubsystem]:DefaultPlatformService=NULL"));
+			return nullptr;
+		}
+		return Subsystem;
+	}
+
+	// Compare the delegates a run saw against the order the subsystem promises
+	void TestSteps(FAutomationTestBase& Test, const USessionBenchmark& Benchmark, const TArray<FString>& ExpectedSteps)
+	{
+		const FString Steps = FString::Join(Benchmark.GetCompletedSteps(), TEXT(", "));
+		Test.TestEqual(TEXT("Delegate order"), Steps, FString::Join(ExpectedSteps, TEXT(", ")));
+		Test.TestEqual(TEXT("Failed or out of order steps"), Benchmark.GetNumFailures(), 0);
+	}
+}
+
+//
+// Waits for a benchmark run to finish, failing the test if it doesn't within the timeout
+//
+class FWaitForSessionBenchmark : public IAutomationLatentCommand
+{
+public:
+	FWaitForSessionBenchmark(FAutomationTestBase* InTest, TStrongObjectPtr<USessionBenchmark> InBenchmark, TArray<FString> InExpectedSteps)
+		: Test(InTest)
+		, Benchmark(MoveTemp(InBenchmark))
+		, ExpectedSteps(MoveTemp(InExpectedSteps))
+	{
+	}
+
+	virtual bool Update() override
+	{
+		if (Benchmark->IsRunning())
+		{
+			if (GetCurrentRunTime() < MultiplayerSessionsTests::RunTimeout)
+			{
+				return false;
+			}
+			Test->AddError(FString::Printf(TEXT("Timed out after %.0f s waiting for the session delegates"), MultiplayerSessionsTests::RunTimeout));
+			Benchmark->Cancel();
+		}
+
+		MultiplayerSessionsTests::TestSteps(*Test, *Benchmark, ExpectedSteps);
+		return true;
+	}
+
+private:
+	FAutomationTestBase* Test;
+	TStrongObjectPtr<USessionBenchmark> Benchmark;
+	TArray<FString> ExpectedSteps;
+};
+
+//
+// Joins the session of a host process, searching again until the host is advertising it, then waits for the host to exit cleanly
+//
+class FJoinHostedSession : public IAutomationLatentCommand
+{
+public:
+	FJoinHostedSession(FAutomationTestBase* InTest, UMultiplayerSessionsSubsystem* InSubsystem, FProcHandle InHostProcess)
+		: Test(InTest)
+		, Subsystem(InSubsystem)
+		, HostProcess(InHostProcess)
+	{
+	}
+
+	virtual ~FJoinHostedSession() override
+	{
+		if (HostProcess.IsValid())
+		{
+			FPlatformProcess::TerminateProc(HostProcess, true);
+			FPlatformProcess::CloseProc(HostProcess);
+		}
+	}
+
+	virtual bool Update() override
+	{
+		if (!Subsystem.IsValid())
+		{
+			Test->AddError(TEXT("The game instance went away during the test"));
+			return true;
+		}
+
+		if (!bJoined)
+		{
+			return UpdateJoin();
+		}
+		return UpdateHost();
+	}
+
+private:
+	bool UpdateJoin()
+	{
+		if (Benchmark.IsValid() && Benchmark->IsRunning())
+		{
+			if (FPlatformTime::Seconds() - RunStartTime < MultiplayerSessionsTests::RunTimeout)
+			{
+				return false;
+			}
+			Test->AddError(FString::Printf(TEXT("Timed out after %.0f s waiting for the session delegates"), MultiplayerSessionsTests::RunTimeout));
+			Benchmark->Cancel();
+			return true;
+		}
+
+		// Until the host advertises its session a search comes back empty, which isn't a failure of the subsystem
+		const bool bHostNotFound = Benchmark.IsValid() && Benchmark->GetCompletedSteps().Num() == 1 && Benchmark->GetCompletedSteps()[0] == TEXT("Find (failed)");
+		if (Benchmark.IsValid() && !bHostNotFound)
+		{
+			MultiplayerSessionsTests::TestSteps(*Test, *Benchmark, { TEXT("Find"), TEXT("BestSessions"), TEXT("Join"), TEXT("Destroy") });
+			bJoined = true;
+			return false;
+		}
+
+		if (GetCurrentRunTime() >= MultiplayerSessionsTests::HostStartupTimeout)
+		{
+			Test->AddError(FString::Printf(TEXT("No hosted session was found within %.0f s"), MultiplayerSessionsTests::HostStartupTimeout));
+			return true;
+		}
+		if (!FPlatformProcess::IsProcRunning(HostProcess))
+		{
+			Test->AddError(TEXT("The host process exited before its session was found"));
+			return true;
+		}
+
+		Benchmark.Reset(NewObject<USessionBenchmark>());
+		Benchmark->Run(Subsystem.Get(), ESessionBenchmarkMode::Join, 1, 0.f, TEXT("FreeForAll"));
+		RunStartTime = FPlatformTime::Seconds();
+		return false;
+	}
+
+	// The host checks its own Create, Start, Hold and Destroy order and exits with a non-zero code if it saw anything wrong
+	bool UpdateHost()
+	{
+		if (FPlatformProcess::IsProcRunning(HostProcess))
+		{
+			if (GetCurrentRunTime() < MultiplayerSessionsTests::HostStartupTimeout + MultiplayerSessionsTests::HostHoldSeconds)
+			{
+				return false;
+			}
+			Test->AddError(TEXT("Timed out waiting for the host process to destroy its session and exit"));
+			return true;
+		}
+
+		int32 ReturnCode = -1;
+		FPlatformProcess::GetProcReturnCode(HostProcess, &ReturnCode);
+		FPlatformProcess::CloseProc(HostProcess);
+		Test->TestEqual(TEXT("Host process exit code"), ReturnCode, 0);
+		return true;
+	}
+
+	FAutomationTestBase* Test;
+	TWeakObjectPtr<UMultiplayerSessionsSubsystem> Subsystem;
+	FProcHandle HostProcess;
+	TStrongObjectPtr<USessionBenchmark> Benchmark;
+	double RunStartTime{ 0.0 };
+	bool bJoined{ false };
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsHostCycleTest, "MultiplayerSessions.HostCycle",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsHostCycleTest::RunTest(const FString& Parameters)
+{
+	UMultiplayerSessionsSubsystem* Subsystem = MultiplayerSessionsTests::FindSubsystem(*this);
+	if (Subsystem == nullptr)
+	{
+		return false;
+	}
+
+	TStrongObjectPtr<USessionBenchmark> Benchmark(NewObject<USessionBenchmark>());
+	Benchmark->Run(Subsystem, ESessionBenchmarkMode::Cycle, 1, 0.f, TEXT("FreeForAll"));
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForSessionBenchmark(this, Benchmark, { TEXT("Create"), TEXT("Start"), TEXT("Destroy") }));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerSessionsHostAndJoinTest, "MultiplayerSessions.HostAndJoin",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FMultiplayerSessionsHostAndJoinTest::RunTest(const FString& Parameters)
+{
+	UMultiplayerSessionsSubsystem* Subsystem = MultiplayerSessionsTests::FindSubsystem(*this);
+	if (Subsystem == nullptr)
+	{
+		return false;
+	}
+
+	FString HostParams;
+#if WITH_EDITOR
+	HostParams = FString::Printf(TEXT("\"%s\" "), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+#endif
+	HostParams += FString::Printf(
+		TEXT("-game -nullrhi -nosound -unattended -SessionBenchExit -ini:Engine:[OnlineSubsystem]:DefaultPlatformService=NULL -ExecCmds=\"MultiplayerSessions.Bench Host %.0f\""),
+		MultiplayerSessionsTests::HostHoldSeconds);
+
+	FProcHandle HostProcess = FPlatformProcess::CreateProc(FPlatformProcess::ExecutablePath(), *HostParams, false, true, true, nullptr, 0, nullptr, nullptr);
+	if (!HostProcess.IsValid())
+	{
+		AddError(FString::Printf(TEXT("Couldn't start the host process %s %s"), FPlatformProcess::ExecutablePath(), *HostParams));
+		return false;
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FJoinHostedSession(this, Subsystem, HostProcess));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
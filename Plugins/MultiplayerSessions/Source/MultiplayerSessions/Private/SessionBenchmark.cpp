@@ -0,0 +1,274 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SessionBenchmark.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "OnlineSessionSettings.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "UObject/StrongObjectPtr.h"
+
+//
+// Only one run at a time, kept alive here between console commands
+//
+static TStrongObjectPtr<USessionBenchmark> ActiveSessionBenchmark;
+
+static FAutoConsoleCommandWithWorldAndArgs SessionBenchmarkCommand(
+	TEXT("MultiplayerSessions.Bench"),
+	TEXT("Benchmark and check the session subsystem. Usage: MultiplayerSessions.Bench Cycle|Host|Join [Iterations or HoldSeconds for Host] [MatchType]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		UMultiplayerSessionsSubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+		if (Subsystem == nullptr)
+		{
+			UE_LOG(LogOnline, Error, TEXT("MultiplayerSessions.Bench needs a game instance"));
+			return;
+		}
+		if (ActiveSessionBenchmark.IsValid() && ActiveSessionBenchmark->IsRunning())
+		{
+			UE_LOG(LogOnline, Warning, TEXT("MultiplayerSessions.Bench is already running"));
+			return;
+		}
+
+		ESessionBenchmarkMode Mode = ESessionBenchmarkMode::Cycle;
+		if (Args.Num() > 0)
+		{
+			if (Args[0].Equals(TEXT("Host"), ESearchCase::IgnoreCase))
+			{
+				Mode = ESessionBenchmarkMode::Host;
+			}
+			else if (Args[0].Equals(TEXT("Join"), ESearchCase::IgnoreCase))
+			{
+				Mode = ESessionBenchmarkMode::Join;
+			}
+		}
+		const float Count = Args.Num() > 1 ? FCString::Atof(*Args[1]) : 10.f;
+		const FString MatchType = Args.Num() > 2 ? Args[2] : FString(TEXT("FreeForAll"));
+
+		ActiveSessionBenchmark.Reset(NewObject<USessionBenchmark>(GameInstance));
+		if (Mode == ESessionBenchmarkMode::Host)
+		{
+			ActiveSessionBenchmark->Run(Subsystem, Mode, 1, Count, MatchType);
+		}
+		else
+		{
+			ActiveSessionBenchmark->Run(Subsystem, Mode, FMath::Max(FMath::RoundToInt(Count), 1), 0.f, MatchType);
+		}
+	}));
+
+void USessionBenchmark::Run(UMultiplayerSessionsSubsystem* InSubsystem, ESessionBenchmarkMode InMode, int32 InIterations, float InHoldSeconds, const FString& InMatchType)
+{
+	Subsystem = InSubsystem;
+	Mode = InMode;
+	Iterations = InIterations;
+	HoldSeconds = InHoldSeconds;
+	MatchType = InMatchType;
+
+	Subsystem->MultiplayerOnCreateSessionComplete.AddDynamic(this, &ThisClass::OnCreateSession);
+	Subsystem->MultiplayerOnStartSessionComplete.AddDynamic(this, &ThisClass::OnStartSession);
+	Subsystem->MultiplayerOnDestroySessionComplete.AddDynamic(this, &ThisClass::OnDestroySession);
+	FindSessionsHandle = Subsystem->MultiplayerOnFindSessionsComplete.AddUObject(this, &ThisClass::OnFindSessions);
+	BestSessionsHandle = Subsystem->MultiplayerOnBestSessionsFound.AddUObject(this, &ThisClass::OnBestSessionsFound);
+	JoinSessionHandle = Subsystem->MultiplayerOnJoinSessionComplete.AddUObject(this, &ThisClass::OnJoinSession);
+
+	bRunning = true;
+	Iteration = 0;
+	NumFailures = 0;
+	CompletedSteps.Reset();
+	RunStartTime = FPlatformTime::Seconds();
+	BeginIteration();
+}
+
+void USessionBenchmark::BeginIteration()
+{
+	if (Iteration >= Iterations)
+	{
+		Finish();
+		return;
+	}
+
+	Iteration++;
+	if (Mode == ESessionBenchmarkMode::Join)
+	{
+		BeginStep(EStep::Find);
+		Subsystem->FindSessions(10000, MatchType);
+	}
+	else
+	{
+		BeginStep(EStep::Create);
+		Subsystem->CreateSession(4, MatchType);
+	}
+}
+
+void USessionBenchmark::BeginStep(EStep Step)
+{
+	CurrentStep = Step;
+	StepStartTime = FPlatformTime::Seconds();
+}
+
+bool USessionBenchmark::EndStep(EStep Step, bool bWasSuccessful)
+{
+	if (!bRunning)
+	{
+		return false;
+	}
+	if (Step != CurrentStep)
+	{
+		UE_LOG(LogOnline, Error, TEXT("Bench %d/%d: %s fired while waiting for %s"), Iteration, Iterations, GetStepName(Step), GetStepName(CurrentStep));
+		CompletedSteps.Add(FString::Printf(TEXT("%s (out of order)"), GetStepName(Step)));
+		NumFailures++;
+		return false;
+	}
+
+	CompletedSteps.Add(bWasSuccessful ? FString(GetStepName(Step)) : FString::Printf(TEXT("%s (failed)"), GetStepName(Step)));
+
+	UE_LOG(LogOnline, Display, TEXT("Bench %d/%d: %-12s %s in %.3f s"), Iteration, Iterations, GetStepName(Step),
+		bWasSuccessful ? TEXT("succeeded") : TEXT("failed"), FPlatformTime::Seconds() - StepStartTime);
+	if (!bWasSuccessful)
+	{
+		NumFailures++;
+	}
+	return true;
+}
+
+void USessionBenchmark::Finish()
+{
+	bRunning = false;
+	CurrentStep = EStep::None;
+	FTSTicker::GetCoreTicker().RemoveTicker(HoldTickerHandle);
+
+	if (Subsystem)
+	{
+		Subsystem->MultiplayerOnCreateSessionComplete.RemoveDynamic(this, &ThisClass::OnCreateSession);
+		Subsystem->MultiplayerOnStartSessionComplete.RemoveDynamic(this, &ThisClass::OnStartSession);
+		Subsystem->MultiplayerOnDestroySessionComplete.RemoveDynamic(this, &ThisClass::OnDestroySession);
+		Subsystem->MultiplayerOnFindSessionsComplete.Remove(FindSessionsHandle);
+		Subsystem->MultiplayerOnBestSessionsFound.Remove(BestSessionsHandle);
+		Subsystem->MultiplayerOnJoinSessionComplete.Remove(JoinSessionHandle);
+		Subsystem->LogOperationStats();
+	}
+
+	UE_LOG(LogOnline, Display, TEXT("Bench finished %d iterations in %.3f s with %d failures"), Iteration, FPlatformTime::Seconds() - RunStartTime, NumFailures);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("SessionBenchExit")))
+	{
+		FPlatformMisc::RequestExitWithStatus(false, NumFailures > 0 ? 1 : 0);
+	}
+}
+
+void USessionBenchmark::Cancel()
+{
+	if (!bRunning)
+	{
+		return;
+	}
+
+	UE_LOG(LogOnline, Error, TEXT("Bench %d/%d: cancelled while waiting for %s"), Iteration, Iterations, GetStepName(CurrentStep));
+	NumFailures++;
+	Finish();
+}
+
+const TCHAR* USessionBenchmark::GetStepName(EStep Step)
+{
+	switch (Step)
+	{
+	case EStep::Create: return TEXT("Create");
+	case EStep::Start: return TEXT("Start");
+	case EStep::Hold: return TEXT("Hold");
+	case EStep::Find: return TEXT("Find");
+	case EStep::BestSessions: return TEXT("BestSessions");
+	case EStep::Join: return TEXT("Join");
+	case EStep::Destroy: return TEXT("Destroy");
+	default: return TEXT("None");
+	}
+}
+
+void USessionBenchmark::OnCreateSession(bool bWasSuccessful)
+{
+	if (!EndStep(EStep::Create, bWasSuccessful)) return;
+
+	if (!bWasSuccessful)
+	{
+		BeginIteration();
+		return;
+	}
+	BeginStep(EStep::Start);
+	Subsystem->StartSession();
+}
+
+void USessionBenchmark::OnStartSession(bool bWasSuccessful)
+{
+	if (!EndStep(EStep::Start, bWasSuccessful)) return;
+
+	if (Mode == ESessionBenchmarkMode::Host && HoldSeconds > 0.f)
+	{
+		BeginStep(EStep::Hold);
+		HoldTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ThisClass::OnHoldFinished), HoldSeconds);
+		return;
+	}
+	BeginStep(EStep::Destroy);
+	Subsystem->DestroySession();
+}
+
+bool USessionBenchmark::OnHoldFinished(float DeltaTime)
+{
+	HoldTickerHandle.Reset();
+	if (EndStep(EStep::Hold, true))
+	{
+		BeginStep(EStep::Destroy);
+		Subsystem->DestroySession();
+	}
+	return false;
+}
+
+void USessionBenchmark::OnFindSessions(const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful)
+{
+	const bool bFoundSession = bWasSuccessful && SessionResults.Num() > 0;
+	if (!EndStep(EStep::Find, bFoundSession)) return;
+
+	if (!bFoundSession)
+	{
+		BeginIteration();
+		return;
+	}
+	BeginStep(EStep::BestSessions);
+	Subsystem->FindBestSessions(1);
+}
+
+void USessionBenchmark::OnBestSessionsFound(const TArray<FOnlineSessionSearchResult>& BestSessions)
+{
+	if (!EndStep(EStep::BestSessions, BestSessions.Num() > 0)) return;
+
+	if (BestSessions.Num() == 0)
+	{
+		BeginIteration();
+		return;
+	}
+	BeginStep(EStep::Join);
+	Subsystem->JoinSession(BestSessions[0]);
+}
+
+void USessionBenchmark::OnJoinSession(EOnJoinSessionCompleteResult::Type Result)
+{
+	if (!EndStep(EStep::Join, Result == EOnJoinSessionCompleteResult::Success)) return;
+
+	if (Result != EOnJoinSessionCompleteResult::Success)
+	{
+		BeginIteration();
+		return;
+	}
+
+	// Leave the joined session without travelling, so the next iteration starts clean
+	BeginStep(EStep::Destroy);
+	Subsystem->DestroySession();
+}
+
+void USessionBenchmark::OnDestroySession(bool bWasSuccessful)
+{
+	if (!EndStep(EStep::Destroy, bWasSuccessful)) return;
+
+	BeginIteration();
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SessionPingProber.h"
+#include "Icmp.h"
+
+void FSessionPingProber::Probe(const TArray<FString>& HostAddresses, TFunction<void()> OnComplete)
+{
+	OnProbesComplete = MoveTemp(OnComplete);
+	PendingAddresses.Reset();
+	for (const FString& HostAddress : HostAddresses)
+	{
+		if (!GetCachedPing(HostAddress).IsSet())
+		{
+			PendingAddresses.AddUnique(HostAddress);
+		}
+	}
+	StartProbes();
+}
+
+TOptional<float> FSessionPingProber::GetCachedPing(const FString& HostAddress) const
+{
+	const FCachedPing* CachedPing = Cache.Find(HostAddress);
+	if (CachedPing && FPlatformTime::Seconds() - CachedPing->Time <= CacheTimeToLive)
+	{
+		return CachedPing->PingMs;
+	}
+	return TOptional<float>();
+}
+
+void FSessionPingProber::Cancel()
+{
+	PendingAddresses.Reset();
+	OnProbesComplete = nullptr;
+}
+
+void FSessionPingProber::StartProbes()
+{
+	while (NumInFlight < MaxInFlightProbes && PendingAddresses.Num() > 0)
+	{
+		const FString HostAddress = PendingAddresses.Pop(EAllowShrinking::No);
+		++NumInFlight;
+
+		TWeakPtr<FSessionPingProber> WeakThis = AsShared();
+		FIcmp::IcmpEcho(HostAddress, ProbeTimeout, [WeakThis, HostAddress](FIcmpEchoResult Result)
+		{
+			if (TSharedPtr<FSessionPingProber> This = WeakThis.Pin())
+			{
+				This->OnProbeComplete(HostAddress, Result.Status == EIcmpResponseStatus::Success, Result.Time);
+			}
+		});
+	}
+
+	if (NumInFlight == 0 && PendingAddresses.Num() == 0 && OnProbesComplete)
+	{
+		TFunction<void()> OnComplete = MoveTemp(OnProbesComplete);
+		OnProbesComplete = nullptr;
+		OnComplete();
+	}
+}
+
+void FSessionPingProber::OnProbeComplete(const FString& HostAddress, bool bSuccess, float PingSeconds)
+{
+	--NumInFlight;
+
+	// Unreachable hosts are cached too, so they are not probed again until the entry expires
+	FCachedPing& CachedPing = Cache.FindOrAdd(HostAddress);
+	CachedPing.PingMs = bSuccess ? PingSeconds * 1000.f : TNumericLimits<float>::Max();
+	CachedPing.Time = FPlatformTime::Seconds();
+
+	StartProbes();
+}
@@ -29,6 +29,7 @@ protected:
 	UFUNCTION()
 	void OnCreateSession(bool bWasSuccessful);
 	void OnFindSessions(const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful);
+	void OnBestSessionsFound(const TArray<FOnlineSessionSearchResult>& BestSessions);
 	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
 	UFUNCTION()
 	void OnDestroySession(bool bWasSuccessful);
@@ -57,4 +58,7 @@ private:
 	int32 NumPublicConnections{4};
 	FString MatchType{TEXT("FreeForAll")};
 	FString PathToLobby{TEXT("")};
+
+	// Set once OnBestSessionsFound has started joining a session, so a second best sessions result doesn't join again
+	bool bJoiningSession{false};
 };
@@ -5,18 +5,54 @@
 #include "CoreMinimal.h"
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Interfaces/OnlineSessionInterface.h"
+#include "OnlineSessionSettings.h"
+#include "Containers/Ticker.h"
 
 #include "MultiplayerSessionsSubsystem.generated.h"
 
+class FSessionPingProber;
+
 //
 // Delcaring our own custom delegates for the Menu class to bind callbacks to
 //
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnCreateSessionComplete, bool, bWasSuccessful);
 DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionsComplete, const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful);
+DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnBestSessionsFound, const TArray<FOnlineSessionSearchResult>& BestSessions);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FMultiplayerOnFindSessionsPage, TConstArrayView<FOnlineSessionSearchResult> PageResults, bool bIsLastPage);
 DECLARE_MULTICAST_DELEGATE_OneParam(FMultiplayerOnJoinSessionComplete, EOnJoinSessionCompleteResult::Type Result);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnDestroySessionComplete, bool, bWasSuccessful);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FMultiplayerOnStartSessionComplete, bool, bWasSuccessful);
 
+//
+// Session operations run one at a time through the operation queue
+//
+enum class ESessionOperationType : uint8
+{
+	Create,
+	Find,
+	Join,
+	Destroy,
+	Start,
+
+	Max
+};
+
+//
+// Latency and outcome counters for one type of session operation
+//
+struct FSessionOperationStats
+{
+	int32 NumSucceeded{ 0 };
+	int32 NumFailed{ 0 };
+	int32 NumRetries{ 0 };
+	int32 NumTimeouts{ 0 };
+
+	// Seconds from the operation being queued to its final result, including waiting behind other operations and retries
+	double LastSeconds{ 0.0 };
+	double TotalSeconds{ 0.0 };
+	double MaxSeconds{ 0.0 };
+};
+
 /**
  * 
  */
@@ -27,26 +63,62 @@ class MULTIPLAYERSESSIONS_API UMultiplayerSessionsSubsystem : public UGameInstan
 public:
 	UMultiplayerSessionsSubsystem();
 
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
 	//
-	// To handle session functionality. The Menu class will call these
+	// To handle session functionality. The Menu class will call these.
+	// Each call is queued and runs once the operations before it have finished, so a create always follows the destroy it needs
 	//
 	void CreateSession(int32 NumPublicConnections, FString MatchType);
-	void FindSessions(int32 MaxSearchResults);
+	// Results matching MatchType (any match type if empty) are delivered through MultiplayerOnFindSessionsPage in the frames they arrive in
+	// while the search runs, then all at once through MultiplayerOnFindSessionsComplete as soon as it finishes
+	void FindSessions(int32 MaxSearchResults, const FString& MatchType = FString());
 	void JoinSession(const FOnlineSessionSearchResult& SessionResult);
+
+	// Ping the hosts of the last search results and broadcast the BestCount sessions with the lowest ping, best first
+	void FindBestSessions(int32 BestCount);
 	void DestroySession();
 	void StartSession();
 
 	bool IsValidSessionInterface();
 
+	// Return true if this instance currently has a game session
+	bool HasGameSession();
+
+	const FSessionOperationStats& GetOperationStats(ESessionOperationType Type) const { return OperationStats[static_cast<int32>(Type)]; }
+
+	// Seconds from the last CreateSession call to the session being created
+	double GetLastHostSeconds() const { return LastHostSeconds; }
+
+	// Seconds from the last FindSessions call to the session being joined
+	double GetLastJoinSeconds() const { return LastJoinSeconds; }
+
+	void LogOperationStats() const;
+
+	// Seconds an attempt may take before it is treated as failed
+	float OperationTimeout{ 15.f };
+
+	// Extra attempts after a failed or timed out attempt
+	int32 MaxOperationRetries{ 2 };
+
+	// Seconds to wait before retrying
+	float OperationRetryDelay{ 1.f };
+
 	//
 	// Our own custom delegates for the Menu class to bind callbacks to
 	//
 	FMultiplayerOnCreateSessionComplete MultiplayerOnCreateSessionComplete;
 	FMultiplayerOnFindSessionsComplete MultiplayerOnFindSessionsComplete;
+	FMultiplayerOnFindSessionsPage MultiplayerOnFindSessionsPage;
+	FMultiplayerOnBestSessionsFound MultiplayerOnBestSessionsFound;
 	FMultiplayerOnJoinSessionComplete MultiplayerOnJoinSessionComplete;
 	FMultiplayerOnDestroySessionComplete MultiplayerOnDestroySessionComplete;
 	FMultiplayerOnStartSessionComplete MultiplayerOnStartSessionComplete;
 
+	// Most search results whose hosts are pinged by FindBestSessions
+	int32 MaxPingCandidates{ 32 };
+
 protected:
 
 	//
@@ -79,7 +151,87 @@ private:
 	FOnStartSessionCompleteDelegate StartSessionCompleteDelegate;
 	FDelegateHandle StartSessionCompleteDelegateHandle;
 
-	bool bCreateSessionOnDestroy{ false };
-	int32 LastNumPublicConnections;
+	//
+	// Streamed delivery of the results of the running search
+	//
+	bool TickSearchResults(float DeltaTime);
+	void StopSearchResultsStreaming();
+
+	// Filter the results that arrived since the last page and broadcast them as the next page
+	void DeliverNewSearchResults(bool bIsLastPage);
+
+	FTSTicker::FDelegateHandle SearchResultsTickerHandle;
+	int32 NextSearchResultIndex{ 0 };
+	FString LastSearchMatchType;
+
+	//
+	// Ping ranking of the last search results
+	//
+	void OnPingProbesComplete(int32 BestCount);
+	FString GetHostAddress(const FOnlineSessionSearchResult& SessionResult) const;
+
+	TSharedPtr<FSessionPingProber> PingProber;
+	TArray<FOnlineSessionSearchResult> BestSessions;
+
+	//
+	// Operation queue. Begin starts an attempt and returns false if the online subsystem rejected it.
+	// Finish runs once with the final result, after any retries.
+	// Online subsystems such as NULL may complete an attempt inside Begin, so nothing may rely on the operation surviving its Begin call
+	//
+	struct FSessionOperation
+	{
+		ESessionOperationType Type;
+		TFunction<bool()> Begin;
+		TFunction<void(bool)> Finish;
+		uint32 Serial{ 0 };
+		int32 NumAttempts{ 0 };
+		double QueuedTime{ 0.0 };
+		double AttemptStartTime{ 0.0 };
+		double RetryTime{ 0.0 };
+		bool bWaitingToRetry{ false };
+
+		// Destroy NAME_GameSession before each attempt if it exists, checked when the attempt begins rather than when queued
+		bool bRequiresNoSession{ false };
+		int32 SessionDestroyedForAttempt{ 0 };
+	};
+
+	void EnqueueOperation(ESessionOperationType Type, TFunction<bool()> Begin, TFunction<void(bool)> Finish, bool bRequiresNoSession = false);
+	void BeginNextOperation();
+	void BeginOperationAttempt();
+	bool IsCurrentOperation(uint32 Serial) const;
+
+	// Called with the result of the current attempt of an operation of the given type
+	void CompleteOperation(ESessionOperationType Type, bool bWasSuccessful, bool bCanRetry = true);
+
+	bool TickOperationQueue(float DeltaTime);
+	void ClearOperationDelegate(ESessionOperationType Type);
+
+	bool BeginCreateSession();
+	bool BeginFindSessions();
+	bool BeginJoinSession();
+	bool BeginDestroySession();
+	bool BeginStartSession();
+
+	// Deliver the rest of the results of a finished search and broadcast completion
+	void DeliverSearchResults(bool bWasSuccessful);
+
+	TArray<FSessionOperation> OperationQueue;
+	bool bOperationInProgress{ false };
+
+	// True while an attempt's Begin runs. Completions during it leave starting the next operation to BeginNextOperation's loop
+	bool bBeginningAttempt{ false };
+	uint32 NextOperationSerial{ 0 };
+	FTSTicker::FDelegateHandle OperationQueueTickerHandle;
+
+	FSessionOperationStats OperationStats[static_cast<int32>(ESessionOperationType::Max)];
+	double HostStartTime{ 0.0 };
+	double JoinStartTime{ 0.0 };
+	double LastHostSeconds{ 0.0 };
+	double LastJoinSeconds{ 0.0 };
+
+	int32 LastNumPublicConnections{ 4 };
 	FString LastMatchType;
+	int32 LastMaxSearchResults{ 10000 };
+	TOptional<FOnlineSessionSearchResult> LastJoinSessionResult;
+	EOnJoinSessionCompleteResult::Type LastJoinResult{ EOnJoinSessionCompleteResult::UnknownError };
 };
@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Interfaces/OnlineSessionInterface.h"
+#include "Containers/Ticker.h"
+#include "SessionBenchmark.generated.h"
+
+class UMultiplayerSessionsSubsystem;
+
+UENUM()
+enum class ESessionBenchmarkMode : uint8
+{
+	// Create, start and destroy a session in one instance
+	Cycle,
+	// Create and start a session, keep it for HoldSeconds so other instances can join, then destroy it
+	Host,
+	// Find, join and leave a session hosted by another instance
+	Join
+};
+
+/**
+ * Drives UMultiplayerSessionsSubsystem through repeated create/find/join cycles, checks that its delegates fire in the expected order
+ * and logs the latency of every step. Meant to be run against the NULL online subsystem on localhost, e.g. a host and a client:
+ *
+ *   UnrealEditor Blaster.uproject -game -nullrhi -ini:Engine:[OnlineSubsystem]:DefaultPlatformService=NULL -ExecCmds="MultiplayerSessions.Bench Host 60"
+ *   UnrealEditor Blaster.uproject -game -nullrhi -ini:Engine:[OnlineSubsystem]:DefaultPlatformService=NULL -ExecCmds="MultiplayerSessions.Bench Join 20" -SessionBenchExit
+ *
+ * With -SessionBenchExit the process exits when the run is over, with a non-zero code if any step failed or fired out of order.
+ */
+UCLASS()
+class MULTIPLAYERSESSIONS_API USessionBenchmark : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	void Run(UMultiplayerSessionsSubsystem* InSubsystem, ESessionBenchmarkMode InMode, int32 InIterations, float InHoldSeconds, const FString& InMatchType);
+
+	bool IsRunning() const { return bRunning; }
+
+	int32 GetNumFailures() const { return NumFailures; }
+
+	// Every delegate that fired during the run, in order, e.g. "Create", "Find (failed)" or "Destroy (out of order)"
+	const TArray<FString>& GetCompletedSteps() const { return CompletedSteps; }
+
+	// Stop a run that is still waiting for a delegate, counting it as a failure
+	void Cancel();
+
+private:
+	//
+	// Each step of a run waits for exactly one subsystem delegate
+	//
+	enum class EStep : uint8
+	{
+		None,
+		Create,
+		Start,
+		Hold,
+		Find,
+		BestSessions,
+		Join,
+		Destroy
+	};
+
+	void BeginIteration();
+	void BeginStep(EStep Step);
+
+	// Check the delegate that fired belongs to the current step, then record its latency
+	bool EndStep(EStep Step, bool bWasSuccessful);
+	void Finish();
+
+	static const TCHAR* GetStepName(EStep Step);
+
+	//
+	// Callbacks for the custom delegates on the MultiplayerSessionsSubsystem
+	//
+	UFUNCTION()
+	void OnCreateSession(bool bWasSuccessful);
+	UFUNCTION()
+	void OnStartSession(bool bWasSuccessful);
+	UFUNCTION()
+	void OnDestroySession(bool bWasSuccessful);
+	void OnFindSessions(const TArray<FOnlineSessionSearchResult>& SessionResults, bool bWasSuccessful);
+	void OnBestSessionsFound(const TArray<FOnlineSessionSearchResult>& BestSessions);
+	void OnJoinSession(EOnJoinSessionCompleteResult::Type Result);
+
+	bool OnHoldFinished(float DeltaTime);
+
+	UPROPERTY()
+	TObjectPtr<UMultiplayerSessionsSubsystem> Subsystem;
+
+	ESessionBenchmarkMode Mode{ ESessionBenchmarkMode::Cycle };
+	int32 Iterations{ 1 };
+	float HoldSeconds{ 0.f };
+	FString MatchType;
+
+	bool bRunning{ false };
+	int32 Iteration{ 0 };
+	EStep CurrentStep{ EStep::None };
+	double StepStartTime{ 0.0 };
+	double RunStartTime{ 0.0 };
+	int32 NumFailures{ 0 };
+	TArray<FString> CompletedSteps;
+
+	FDelegateHandle FindSessionsHandle;
+	FDelegateHandle BestSessionsHandle;
+	FDelegateHandle JoinSessionHandle;
+	FTSTicker::FDelegateHandle HoldTickerHandle;
+};
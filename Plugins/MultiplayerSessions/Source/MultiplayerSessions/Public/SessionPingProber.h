@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Measures the ping to session hosts with ICMP echoes.
+ * At most MaxInFlightProbes echoes are outstanding at once, and results are cached for CacheTimeToLive seconds.
+ */
+class MULTIPLAYERSESSIONS_API FSessionPingProber : public TSharedFromThis<FSessionPingProber>
+{
+public:
+	// Probe every address without a fresh cached ping, then call OnComplete on the game thread
+	void Probe(const TArray<FString>& HostAddresses, TFunction<void()> OnComplete);
+
+	// Return the cached ping in milliseconds, or an unset value if the host has not answered recently
+	TOptional<float> GetCachedPing(const FString& HostAddress) const;
+
+	// Forget pending probes. Echoes already in flight still update the cache
+	void Cancel();
+
+	int32 MaxInFlightProbes{ 4 };
+	float ProbeTimeout{ 1.f };
+	double CacheTimeToLive{ 30.0 };
+
+private:
+	struct FCachedPing
+	{
+		float PingMs;
+		double Time;
+	};
+
+	void StartProbes();
+	void OnProbeComplete(const FString& HostAddress, bool bSuccess, float PingSeconds);
+
+	TMap<FString, FCachedPing> Cache;
+	TArray<FString> PendingAddresses;
+	int32 NumInFlight{ 0 };
+	TFunction<void()> OnProbesComplete;
+};
@@ -0,0 +1,116 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AimState.generated.h"
+
+/**
+ * Aim pitch quantized to one byte for replication to simulated proxies. It replaces the pawn's RemoteViewPitch, which costs the same byte
+ * but spends it on a full turn rather than [-90, 90]. Aim yaw is not sent: an armed character turns with its controller, so the yaw in the
+ * replicated movement already is the aim yaw.
+ */
+USTRUCT()
+struct FBlasterAimState
+{
+	GENERATED_BODY()
+
+	static constexpr int32 NumBits = 8;
+	static constexpr uint32 MaxPackedValue = (1u << NumBits) - 1;
+
+	UPROPERTY()
+	uint8 PackedPitch = 0;
+
+	// Quantize the pitch of an aim rotation, clamped to [-90, 90]
+	void Set(const FRotator& AimRotation)
+	{
+		const float Pitch = FMath::Clamp(FRotator::NormalizeAxis(AimRotation.Pitch), -90.f, 90.f);
+		PackedPitch = static_cast<uint8>(FMath::RoundToInt((Pitch + 90.f) / 180.f * MaxPackedValue));
+	}
+
+	float GetPitch() const { return PackedPitch * 180.f / MaxPackedValue - 90.f; }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		Ar.SerializeBits(&PackedPitch, NumBits);
+		bOutSuccess = true;
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FBlasterAimState> : public TStructOpsTypeTraitsBase2<FBlasterAimState>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Buffer of received aim angles, stamped with the synced server time they arrived at and sampled in the past to give smooth remote aim.
+ * Yaw and pitch arrive in different properties, so each has its own buffer.
+ */
+struct FBlasterAimInterpolationBuffer
+{
+	struct FSample
+	{
+		double Time;
+		float Angle;
+	};
+
+	static constexpr int32 MaxSamples = 8;
+
+	void AddSample(double Time, float Angle)
+	{
+		if (!Samples.IsEmpty())
+		{
+			// Updates received in the same frame share a stamp, keep the newest
+			if (Time == Samples.Last().Time)
+			{
+				Samples.Last().Angle = Angle;
+				return;
+			}
+
+			// A stamp that goes backwards means the synced clock was corrected, so start over rather than interpolate out of order
+			if (Time < Samples.Last().Time)
+			{
+				Samples.Reset();
+			}
+		}
+		if (Samples.Num() == MaxSamples)
+		{
+			Samples.RemoveAt(0, 1, EAllowShrinking::No);
+		}
+		Samples.Add({ Time, Angle });
+	}
+
+	bool IsEmpty() const { return Samples.IsEmpty(); }
+
+	// Interpolate the angle at the given time along the shortest way round, holding the oldest or newest sample outside the buffered range
+	float Sample(double Time) const
+	{
+		if (Samples.IsEmpty()) return 0.f;
+
+		if (Time <= Samples[0].Time)
+		{
+			return Samples[0].Angle;
+		}
+
+		for (int32 Index = 1; Index < Samples.Num(); ++Index)
+		{
+			const FSample& To = Samples[Index];
+			if (Time < To.Time)
+			{
+				const FSample& From = Samples[Index - 1];
+				const float Alpha = static_cast<float>((Time - From.Time) / (To.Time - From.Time));
+				return From.Angle + FMath::FindDeltaAngleDegrees(From.Angle, To.Angle) * Alpha;
+			}
+		}
+
+		return Samples.Last().Angle;
+	}
+
+private:
+	TArray<FSample, TInlineAllocator<MaxSamples>> Samples;
+};
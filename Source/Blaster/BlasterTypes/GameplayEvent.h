@@ -0,0 +1,93 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EBlasterGameplayEvent : uint8
+{
+	EBGE_Fire,
+	EBGE_Hit,
+	EBGE_Damage,
+	EBGE_Elimination,
+	EBGE_Respawn,
+	EBGE_Equip,
+	EBGE_Reload,
+
+	EBGE_MAX
+};
+
+inline const TCHAR* LexToString(EBlasterGameplayEvent Event)
+{
+	switch (Event)
+	{
+	case EBlasterGameplayEvent::EBGE_Fire: return TEXT("Fire");
+	case EBlasterGameplayEvent::EBGE_Hit: return TEXT("Hit");
+	case EBlasterGameplayEvent::EBGE_Damage: return TEXT("Damage");
+	case EBlasterGameplayEvent::EBGE_Elimination: return TEXT("Elimination");
+	case EBlasterGameplayEvent::EBGE_Respawn: return TEXT("Respawn");
+	case EBlasterGameplayEvent::EBGE_Equip: return TEXT("Equip");
+	case EBlasterGameplayEvent::EBGE_Reload: return TEXT("Reload");
+	default: return TEXT("Unknown");
+	}
+}
+
+/**
+ * One server-side gameplay event as stored in a Blaster event log.
+ * Players are identified by PlayerId, INDEX_NONE when there is none.
+ */
+struct FBlasterGameplayEvent
+{
+	// Engine frame the event happened in
+	uint32 Frame = 0;
+
+	// World time in seconds
+	float Time = 0.f;
+
+	EBlasterGameplayEvent Type = EBlasterGameplayEvent::EBGE_MAX;
+
+	// Event specific detail: packed hit info for hits, weapon type for equips
+	uint8 Detail = 0;
+
+	// Player the event happened to, or who caused it for fires, equips and reloads
+	int32 PlayerId = INDEX_NONE;
+
+	// Other player involved: the shooter of a hit or damage, the attacker of an elimination
+	int32 OtherPlayerId = INDEX_NONE;
+
+	// Damage for hits and damage, remaining health is not logged
+	float Value = 0.f;
+
+	FVector3f Location = FVector3f::ZeroVector;
+
+	friend FArchive& operator<<(FArchive& Ar, FBlasterGameplayEvent& Event)
+	{
+		uint8 Type = static_cast<uint8>(Event.Type);
+		Ar << Event.Frame << Event.Time << Type << Event.Detail << Event.PlayerId << Event.OtherPlayerId << Event.Value << Event.Location;
+		Event.Type = static_cast<EBlasterGameplayEvent>(Type);
+		return Ar;
+	}
+};
+
+/**
+ * Header at the start of every event log file. Bump Version whenever the layout of FBlasterGameplayEvent changes
+ */
+struct FBlasterGameplayEventLogHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x56454C42; // "BLEV"
+	static constexpr uint32 CurrentVersion = 1;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = CurrentVersion;
+
+	// UTC ticks when the log was started
+	int64 StartTicks = 0;
+
+	FString MapName;
+
+	friend FArchive& operator<<(FArchive& Ar, FBlasterGameplayEventLogHeader& Header)
+	{
+		Ar << Header.Magic << Header.Version << Header.StartTicks << Header.MapName;
+		return Ar;
+	}
+};
@@ -0,0 +1,46 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+UENUM(BlueprintType)
+enum class EHitRegion : uint8
+{
+	EHR_Torso UMETA(DisplayName = "Torso"),
+	EHR_Head UMETA(DisplayName = "Head"),
+	EHR_Arms UMETA(DisplayName = "Arms"),
+	EHR_Legs UMETA(DisplayName = "Legs"),
+
+	EHR_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+UENUM(BlueprintType)
+enum class EHitDirection : uint8
+{
+	EHD_Front UMETA(DisplayName = "Front"),
+	EHD_Back UMETA(DisplayName = "Back"),
+	EHD_Left UMETA(DisplayName = "Left"),
+	EHD_Right UMETA(DisplayName = "Right"),
+
+	EHD_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+// Region and direction of a hit packed into one byte for replication (2 bits each)
+namespace BlasterHitInfo
+{
+	inline uint8 Pack(EHitRegion Region, EHitDirection Direction)
+	{
+		return (static_cast<uint8>(Region) & 0x03) | ((static_cast<uint8>(Direction) & 0x03) << 2);
+	}
+
+	inline EHitRegion GetRegion(uint8 PackedHitInfo)
+	{
+		return static_cast<EHitRegion>(PackedHitInfo & 0x03);
+	}
+
+	inline EHitDirection GetDirection(uint8 PackedHitInfo)
+	{
+		return static_cast<EHitDirection>((PackedHitInfo >> 2) & 0x03);
+	}
+}
@@ -0,0 +1,94 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "InputState.generated.h"
+
+/**
+ * Compact combat input state sent from the owning client to the server at most once per frame.
+ * Button presses are sent as wrapping counters, so a dropped packet is recovered by the next one.
+ */
+USTRUCT()
+struct FBlasterInputState
+{
+	GENERATED_BODY()
+
+	// Masks a packed field to its 4 bits on the wire: the reload, equip and swap counters and the swap slot
+	static constexpr uint8 PressCounterMask = 0x0F;
+
+	// Incremented whenever the state changes, used to drop stale or reordered packets
+	UPROPERTY()
+	uint8 Sequence = 0;
+
+	// Shots requested so far (wrapping)
+	UPROPERTY()
+	uint8 FireCount = 0;
+
+	// Reload presses so far (wrapping, 4 bits on the wire)
+	UPROPERTY()
+	uint8 ReloadCount = 0;
+
+	// Equip presses so far (wrapping, 4 bits on the wire)
+	UPROPERTY()
+	uint8 EquipCount = 0;
+
+	// Weapon swaps so far (wrapping, 4 bits on the wire)
+	UPROPERTY()
+	uint8 SwapCount = 0;
+
+	// Inventory slot requested by the most recent swap (4 bits on the wire)
+	UPROPERTY()
+	uint8 SwapSlot = 0;
+
+	// Aim target of the most recent shot
+	UPROPERTY()
+	FVector_NetQuantize HitTarget = FVector::ZeroVector;
+
+	// Sub-frame offset of the most recent shot, in seconds (whole milliseconds on the wire, like FWeaponFireParams::TimeOffset).
+	// Earlier shots in the same state were spaced by the fire delay before it
+	UPROPERTY()
+	float LastShotTimeOffset = 0.f;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		Ar << Sequence;
+		Ar << FireCount;
+
+		uint8 PackedPressCounters = (ReloadCount & PressCounterMask) | ((EquipCount & PressCounterMask) << 4);
+		Ar << PackedPressCounters;
+		if (Ar.IsLoading())
+		{
+			ReloadCount = PackedPressCounters & PressCounterMask;
+			EquipCount = (PackedPressCounters >> 4) & PressCounterMask;
+		}
+
+		uint8 PackedSwap = (SwapCount & PressCounterMask) | ((SwapSlot & PressCounterMask) << 4);
+		Ar << PackedSwap;
+		if (Ar.IsLoading())
+		{
+			SwapCount = PackedSwap & PressCounterMask;
+			SwapSlot = (PackedSwap >> 4) & PressCounterMask;
+		}
+
+		HitTarget.NetSerialize(Ar, Map, bOutSuccess);
+
+		uint8 PackedLastShotTimeOffset = Ar.IsLoading() ? 0 : static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(LastShotTimeOffset * 1000.f), 0, 255));
+		Ar << PackedLastShotTimeOffset;
+		if (Ar.IsLoading())
+		{
+			LastShotTimeOffset = PackedLastShotTimeOffset / 1000.f;
+		}
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FBlasterInputState> : public TStructOpsTypeTraitsBase2<FBlasterInputState>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
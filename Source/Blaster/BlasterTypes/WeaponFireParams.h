@@ -0,0 +1,115 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "WeaponFireParams.generated.h"
+
+/**
+ * Compact description of a projectile spawned on the server, sent to clients with the shot instead of replicating the projectile actor.
+ * The shooter is the owner of the weapon that fired it.
+ */
+USTRUCT()
+struct FProjectileSpawnEvent
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector_NetQuantize Origin;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	// Initial speed in cm/s
+	UPROPERTY()
+	uint16 Speed = 0;
+
+	// Identifies the projectile in the matching impact event and seeds any cosmetic variation
+	UPROPERTY()
+	uint16 ProjectileId = 0;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		Origin.NetSerialize(Ar, Map, bOutSuccess);
+		Direction.NetSerialize(Ar, Map, bOutSuccess);
+		Ar << Speed;
+		Ar << ProjectileId;
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FProjectileSpawnEvent> : public TStructOpsTypeTraitsBase2<FProjectileSpawnEvent>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
+
+/**
+ * Everything a weapon needs to fire one shot
+ */
+USTRUCT()
+struct FWeaponFireParams
+{
+	GENERATED_BODY()
+
+	// Longest sub-frame offset that survives replication, in seconds
+	static constexpr float MaxTimeOffset = 0.255f;
+
+	// Aim target of the shot
+	UPROPERTY()
+	FVector_NetQuantize HitTarget = FVector::ZeroVector;
+
+	// How long before the end of the frame the shot was due, in seconds. Projectiles are advanced by this much so fire rate doesn't depend on frame rate
+	UPROPERTY()
+	float TimeOffset = 0.f;
+
+	// Spread of the weapon when the shot was fired. Server only, not sent
+	float Spread = 0.f;
+
+	// Seed of the shot's direction inside the spread cone. Server only, not sent
+	uint32 SpreadSeed = 0;
+
+	// Set on the server by weapons whose projectiles clients simulate, so the projectile goes out with the shot
+	UPROPERTY()
+	bool bHasProjectileSpawn = false;
+
+	UPROPERTY()
+	FProjectileSpawnEvent ProjectileSpawn;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+	{
+		uint8 bPackedHasProjectileSpawn = bHasProjectileSpawn ? 1 : 0;
+		Ar.SerializeBits(&bPackedHasProjectileSpawn, 1);
+		bHasProjectileSpawn = bPackedHasProjectileSpawn != 0;
+
+		// A simulated projectile already starts from its sub-frame spawn location, so clients need neither the aim target nor the offset
+		if (bHasProjectileSpawn)
+		{
+			return ProjectileSpawn.NetSerialize(Ar, Map, bOutSuccess);
+		}
+
+		HitTarget.NetSerialize(Ar, Map, bOutSuccess);
+
+		// Whole milliseconds are enough for spawn offsets
+		uint8 PackedTimeOffset = Ar.IsLoading() ? 0 : static_cast<uint8>(FMath::Clamp(FMath::RoundToInt(TimeOffset * 1000.f), 0, 255));
+		Ar << PackedTimeOffset;
+		if (Ar.IsLoading())
+		{
+			TimeOffset = PackedTimeOffset / 1000.f;
+		}
+		return true;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FWeaponFireParams> : public TStructOpsTypeTraitsBase2<FWeaponFireParams>
+{
+	enum
+	{
+		WithNetSerializer = true
+	};
+};
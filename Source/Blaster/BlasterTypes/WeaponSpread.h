@@ -0,0 +1,126 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/RandomStream.h"
+#include "WeaponSpread.generated.h"
+
+/**
+ * Tuning for a weapon's spread, in crosshair spread units
+ */
+USTRUCT()
+struct FWeaponSpreadParams
+{
+	GENERATED_BODY()
+
+	// Spread while standing still
+	UPROPERTY(EditAnywhere)
+	float BaselineSpread = 0.5f;
+
+	// Spread added at full walk speed
+	UPROPERTY(EditAnywhere)
+	float MaxVelocityFactor = 1.f;
+
+	// Spread added after falling for a while
+	UPROPERTY(EditAnywhere)
+	float MaxInAirFactor = 2.f;
+
+	// Spread added while aiming (negative to tighten)
+	UPROPERTY(EditAnywhere)
+	float MaxAimFactor = -0.58f;
+
+	// Spread added by a shot, recovering over the following frames
+	UPROPERTY(EditAnywhere)
+	float MaxShootFactor = 1.f;
+
+	// Rates at which the factors approach their targets, per second
+	UPROPERTY(EditAnywhere)
+	float InAirRate = 2.25f;
+
+	UPROPERTY(EditAnywhere)
+	float LandedRate = 30.f;
+
+	UPROPERTY(EditAnywhere)
+	float AimRate = 30.f;
+
+	UPROPERTY(EditAnywhere)
+	float ShootRecoveryRate = 30.f;
+
+	// Half angle of the shot cone for each unit of spread, in degrees
+	UPROPERTY(EditAnywhere)
+	float DegreesPerSpread = 1.f;
+
+	// View pitch kick of each shot, in degrees
+	UPROPERTY(EditAnywhere)
+	float RecoilPitch = 0.3f;
+
+	// Largest view yaw kick of each shot either way, in degrees
+	UPROPERTY(EditAnywhere)
+	float RecoilYaw = 0.15f;
+};
+
+/**
+ * Spread of a character's weapon, run on the owning client for the crosshairs and on the server for the shots.
+ * Every factor decays exponentially, so the result doesn't depend on how time is split into frames, and shots are timed with the
+ * sub-frame offsets of the fire scheduler. Shot directions and recoil come from a stream seeded by the shot's index in the character's
+ * life, which the server counts from the input states it already receives, mixed with a salt the server picks for each life, so it
+ * reproduces the client's pattern without extra bytes per shot and the pattern never repeats.
+ */
+struct FWeaponSpreadModel
+{
+	// Advance the movement driven factors to the end of the frame
+	void Update(float DeltaTime, float GroundSpeed, float MaxSpeed, bool bIsFalling, bool bIsAiming, const FWeaponSpreadParams& Params)
+	{
+		VelocityFactor = FMath::GetMappedRangeValueClamped(FVector2D(0.f, MaxSpeed), FVector2D(0.f, Params.MaxVelocityFactor), GroundSpeed);
+		InAirFactor = Approach(InAirFactor, bIsFalling ? Params.MaxInAirFactor : 0.f, bIsFalling ? Params.InAirRate : Params.LandedRate, DeltaTime);
+		AimFactor = Approach(AimFactor, bIsAiming ? Params.MaxAimFactor : 0.f, Params.AimRate, DeltaTime);
+		TimeSinceLastShot += DeltaTime;
+	}
+
+	// Return the spread at a time before the end of the frame
+	float GetSpread(const FWeaponSpreadParams& Params, float TimeBeforeNow = 0.f) const
+	{
+		const float ShotAge = FMath::Max(TimeSinceLastShot - TimeBeforeNow, 0.f);
+		const float ShootFactor = Params.MaxShootFactor * FMath::Exp(-Params.ShootRecoveryRate * ShotAge);
+		return FMath::Max(Params.BaselineSpread + VelocityFactor + InAirFactor + AimFactor + ShootFactor, 0.f);
+	}
+
+	// Record a shot fired at a time before the end of the frame
+	void AddShot(float TimeBeforeNow = 0.f)
+	{
+		TimeSinceLastShot = TimeBeforeNow;
+	}
+
+	static uint32 GetShotSeed(uint32 ShotIndex, uint32 Salt)
+	{
+		// Consecutive seeds give correlated first values from a linear congruential stream, so scramble them
+		return MurmurFinalize32(HashCombineFast(Salt, ShotIndex));
+	}
+
+	// Return a direction inside the spread cone around the aim direction
+	static FVector GetShotDirection(const FVector& AimDirection, float Spread, uint32 Seed, const FWeaponSpreadParams& Params)
+	{
+		const FRandomStream Stream(static_cast<int32>(Seed));
+		return Stream.VRandCone(AimDirection.GetSafeNormal(), FMath::DegreesToRadians(Spread * Params.DegreesPerSpread));
+	}
+
+	// Return the view kick of a shot, applied to the control rotation on the owning client
+	static FRotator GetShotRecoil(uint32 Seed, const FWeaponSpreadParams& Params)
+	{
+		// Scrambled again so the kick doesn't follow the direction, which takes the first values of a stream with this seed
+		const FRandomStream Stream(static_cast<int32>(MurmurFinalize32(Seed)));
+		return FRotator(Params.RecoilPitch, Stream.FRandRange(-Params.RecoilYaw, Params.RecoilYaw), 0.f);
+	}
+
+private:
+	static float Approach(float Current, float Target, float Rate, float DeltaTime)
+	{
+		return Target + (Current - Target) * FMath::Exp(-Rate * DeltaTime);
+	}
+
+	float VelocityFactor = 0.f;
+	float InAirFactor = 0.f;
+	float AimFactor = 0.f;
+	float TimeSinceLastShot = TNumericLimits<float>::Max();
+};
@@ -0,0 +1,133 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "BlasterComponents/BlasterCharacterMovementComponent.h"
+
+#include "BlasterComponents/CombatComponent.h"
+#include "Character/BlasterCharacter.h"
+
+/*
+*	Saved move carrying the aiming state
+*/
+class FSavedMove_Blaster : public FSavedMove_Character
+{
+	typedef FSavedMove_Character Super;
+
+public:
+	virtual void Clear() override
+	{
+		Super::Clear();
+		bSavedWantsToAim = false;
+	}
+
+	virtual uint8 GetCompressedFlags() const override
+	{
+		uint8 Result = Super::GetCompressedFlags();
+		if (bSavedWantsToAim)
+		{
+			Result |= FLAG_Custom_0;
+		}
+		return Result;
+	}
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override
+	{
+		// Never merge moves across an aim change, otherwise the speed change is applied at the wrong time
+		if (bSavedWantsToAim != static_cast<const FSavedMove_Blaster*>(NewMove.Get())->bSavedWantsToAim)
+		{
+			return false;
+		}
+		return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+	}
+
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override
+	{
+		Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+		if (const UBlasterCharacterMovementComponent* MovementComponent = Cast<UBlasterCharacterMovementComponent>(C->GetCharacterMovement()))
+		{
+			bSavedWantsToAim = MovementComponent->bWantsToAim;
+		}
+	}
+
+	virtual void PrepMoveFor(ACharacter* C) override
+	{
+		Super::PrepMoveFor(C);
+
+		if (UBlasterCharacterMovementComponent* MovementComponent = Cast<UBlasterCharacterMovementComponent>(C->GetCharacterMovement()))
+		{
+			MovementComponent->bWantsToAim = bSavedWantsToAim;
+		}
+	}
+
+private:
+	bool bSavedWantsToAim = false;
+};
+
+/*
+*	Client prediction data allocating Blaster saved moves
+*/
+class FNetworkPredictionData_Client_Blaster : public FNetworkPredictionData_Client_Character
+{
+	typedef FNetworkPredictionData_Client_Character Super;
+
+public:
+	FNetworkPredictionData_Client_Blaster(const UCharacterMovementComponent& ClientMovement)
+		: Super(ClientMovement)
+	{
+	}
+
+	virtual FSavedMovePtr AllocateNewMove() override
+	{
+		return FSavedMovePtr(new FSavedMove_Blaster());
+	}
+};
+
+float UBlasterCharacterMovementComponent::GetMaxSpeed() const
+{
+	if (bWantsToAim)
+	{
+		// Aim speed replaces the walk speed everywhere the base class would use MaxWalkSpeed
+		switch (MovementMode)
+		{
+		case MOVE_Walking:
+		case MOVE_NavWalking:
+			return IsCrouching() ? MaxWalkSpeedCrouched : AimWalkSpeed;
+		case MOVE_Falling:
+			return AimWalkSpeed;
+		default:
+			break;
+		}
+	}
+	return Super::GetMaxSpeed();
+}
+
+FNetworkPredictionData_Client* UBlasterCharacterMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UBlasterCharacterMovementComponent* MutableThis = const_cast<UBlasterCharacterMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Blaster(*this);
+	}
+	return ClientPredictionData;
+}
+
+void UBlasterCharacterMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	const bool bNewWantsToAim = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	if (bNewWantsToAim == bWantsToAim) return;
+
+	bWantsToAim = bNewWantsToAim;
+
+	// The server learns about aiming from the move itself, so keep the replicated combat state in sync
+	if (CharacterOwner && CharacterOwner->HasAuthority() && !CharacterOwner->IsLocallyControlled())
+	{
+		ABlasterCharacter* BlasterCharacter = Cast<ABlasterCharacter>(CharacterOwner);
+		if (BlasterCharacter && BlasterCharacter->GetCombat())
+		{
+			BlasterCharacter->GetCombat()->SetAimingFromMovement(bWantsToAim);
+		}
+	}
+}
@@ -3,6 +3,7 @@
 
 #include "BlasterComponents/CombatComponent.h"
 
+#include "BlasterComponents/BlasterCharacterMovementComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Character/BlasterCharacter.h"
 #include "Components/SphereComponent.h"
@@ -11,7 +12,7 @@
 #include "Kismet/GameplayStatics.h"
 #include "Net/UnrealNetwork.h"
 #include "PlayerController/BlasterPlayerController.h"
-#include "TimerManager.h"
+#include "Subsystems/BlasterEventLogSubsystem.h"
 #include "Weapon/Weapon.h"
 
 #define TRACE_LENGTH 80000.f;
@@ -26,18 +27,30 @@ void UCombatComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Out
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
 	DOREPLIFETIME(UCombatComponent, CombatState);
-	DOREPLIFETIME(UCombatComponent, EquippedWeapon);
-	DOREPLIFETIME(UCombatComponent, bIsAiming);
-	DOREPLIFETIME_CONDITION(UCombatComponent, CarriedAmmo, COND_OwnerOnly);
+	DOREPLIFETIME(UCombatComponent, Inventory);
+	DOREPLIFETIME(UCombatComponent, ActiveSlot);
+	DOREPLIFETIME_CONDITION(UCombatComponent, AckedSwapCount, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(UCombatComponent, ShotSeedSalt, COND_OwnerOnly);
+	DOREPLIFETIME_CONDITION(UCombatComponent, bIsAiming, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(UCombatComponent, CarriedAmmo, COND_ReplayOrOwner);
 }
 
 void UCombatComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (GetOwner() && GetOwner()->HasAuthority())
+	{
+		ShotSeedSalt = FGuid::NewGuid().A;
+	}
+
 	if (Character)
 	{
 		Character->GetCharacterMovement()->MaxWalkSpeed = BaseWalkSpeed;
+		if (UBlasterCharacterMovementComponent* BlasterMovement = Character->GetBlasterCharacterMovement())
+		{
+			BlasterMovement->AimWalkSpeed = AimWalkSpeed;
+		}
 
 		if (Character->GetFollowCamera())
 		{
@@ -56,14 +69,25 @@ void UCombatComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActo
 {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
+	if (Character && (Character->HasAuthority() || Character->IsLocallyControlled()))
+	{
+		UpdateSpreadModel(DeltaTime);
+	}
+
 	if (Character && Character->IsLocallyControlled())
 	{
 		FHitResult HitResult;
 		TraceUnderCrosshairs(HitResult);
 		HitTarget = HitResult.ImpactPoint;
 
+		UpdateFireScheduler(DeltaTime);
 		UpdateCameraFOV(DeltaTime);
 		UpdateHUDCrosshairs(DeltaTime);
+
+		if (!Character->HasAuthority())
+		{
+			FlushInputState();
+		}
 	}
 }
 
@@ -71,42 +95,177 @@ void UCombatComponent::EquipWeapon(AWeapon* WeaponToEquip)
 {
 	if (!Character || !WeaponToEquip) return;
 
-	if (EquippedWeapon)
+	const uint8 Slot = static_cast<uint8>(WeaponToEquip->GetInventorySlot());
+	if (Slot >= UE_ARRAY_COUNT(Inventory)) return;
+
+	DropWeaponInSlot(Slot);
+
+	Inventory[Slot] = WeaponToEquip;
+	WeaponToEquip->SetWeaponState(EWeaponState::EWS_Equipped);
+	AttachWeaponToHand(WeaponToEquip);
+	WeaponToEquip->SetOwner(Character);
+
+	// The first weapon picked up, or a replacement for the one in hand, goes straight into the hand
+	if (EquippedWeapon == nullptr || Slot == ActiveSlot)
 	{
-		EquippedWeapon->Dropped();
+		ActiveSlot = Slot;
 	}
+	RefreshEquippedWeapon();
+	UpdateCarriedAmmo();
+	UBlasterEventLogSubsystem::Record(Character, EBlasterGameplayEvent::EBGE_Equip, Character, nullptr, 0.f, Character->GetActorLocation(), static_cast<uint8>(WeaponToEquip->GetWeaponType()));
 
-	EquippedWeapon = WeaponToEquip;
-	EquippedWeapon->SetWeaponState(EWeaponState::EWS_Equipped);
+	Character->GetCharacterMovement()->bOrientRotationToMovement = false;
+	Character->bUseControllerRotationYaw = true;
+}
+
+void UCombatComponent::DropWeapons()
+{
+	for (uint8 Slot = 0; Slot < UE_ARRAY_COUNT(Inventory); ++Slot)
+	{
+		DropWeaponInSlot(Slot);
+	}
+	RefreshEquippedWeapon();
+}
+
+void UCombatComponent::DropWeaponInSlot(uint8 Slot)
+{
+	AWeapon* Weapon = Inventory[Slot];
+	if (Weapon == nullptr) return;
+
+	Inventory[Slot] = nullptr;
+	Weapon->Dropped();
+}
+
+void UCombatComponent::AttachWeaponToHand(AWeapon* Weapon)
+{
 	const USkeletalMeshSocket* HandSocket = Character->GetMesh()->GetSocketByName(FName("RightHandSocket"));
 	if (HandSocket)
 	{
-		HandSocket->AttachActor(EquippedWeapon, Character->GetMesh());
+		HandSocket->AttachActor(Weapon, Character->GetMesh());
 	}
-	EquippedWeapon->SetOwner(Character);
-	EquippedWeapon->SetHUDAmmo();
+}
 
-	if (CarriedAmmoMap.Contains(EquippedWeapon->GetWeaponType()))
+void UCombatComponent::RefreshEquippedWeapon()
+{
+	AWeapon* PreviousWeapon = EquippedWeapon;
+	EquippedWeapon = ActiveSlot < UE_ARRAY_COUNT(Inventory) ? Inventory[ActiveSlot] : nullptr;
+
+	// Swapping only changes which carried weapon is visible, nothing is re-attached or re-replicated
+	for (uint8 Slot = 0; Slot < UE_ARRAY_COUNT(Inventory); ++Slot)
 	{
-		CarriedAmmo = CarriedAmmoMap[EquippedWeapon->GetWeaponType()];
+		if (Inventory[Slot] && Inventory[Slot]->GetWeaponMesh())
+		{
+			Inventory[Slot]->GetWeaponMesh()->SetVisibility(Slot == ActiveSlot);
+		}
 	}
+
+	if (EquippedWeapon && EquippedWeapon != PreviousWeapon && Character && Character->IsLocallyControlled())
+	{
+		EquippedWeapon->SetHUDAmmo();
+	}
+}
+
+void UCombatComponent::UpdateCarriedAmmo()
+{
+	if (EquippedWeapon == nullptr) return;
+
+	const uint8 WeaponType = static_cast<uint8>(EquippedWeapon->GetWeaponType());
+	CarriedAmmo = WeaponType < UE_ARRAY_COUNT(CarriedAmmoByType) ? CarriedAmmoByType[WeaponType] : 0;
 	OnRep_CarriedAmmo();
+}
 
-	Character->GetCharacterMovement()->bOrientRotationToMovement = false;
-	Character->bUseControllerRotationYaw = true;
+void UCombatComponent::SwapWeaponButtonPressed()
+{
+	if (Character == nullptr || CombatState != ECombatState::ECS_Unoccupied) return;
+
+	// Next occupied slot after the active one
+	uint8 NextSlot = ActiveSlot;
+	for (uint8 Offset = 1; Offset < UE_ARRAY_COUNT(Inventory); ++Offset)
+	{
+		const uint8 Slot = (ActiveSlot + Offset) % UE_ARRAY_COUNT(Inventory);
+		if (Inventory[Slot])
+		{
+			NextSlot = Slot;
+			break;
+		}
+	}
+	if (NextSlot == ActiveSlot) return;
+
+	if (Character->HasAuthority())
+	{
+		ServerHandleSwap(NextSlot);
+	}
+	else
+	{
+		// Swap locally straight away, the server confirms or corrects it through ActiveSlot
+		ActiveSlot = NextSlot;
+		RefreshEquippedWeapon();
+
+		LocalInputState.SwapCount = (LocalInputState.SwapCount + 1) & FBlasterInputState::PressCounterMask;
+		LocalInputState.SwapSlot = NextSlot;
+		MarkInputStateDirty();
+	}
+}
+
+bool UCombatComponent::ServerHandleSwap(uint8 Slot)
+{
+	if (Slot >= UE_ARRAY_COUNT(Inventory) || Inventory[Slot] == nullptr || CombatState != ECombatState::ECS_Unoccupied) return false;
+	if (Slot == ActiveSlot) return true;
+
+	ActiveSlot = Slot;
+	RefreshEquippedWeapon();
+	UpdateCarriedAmmo();
+	return true;
+}
+
+void UCombatComponent::ClientRejectSwap_Implementation(uint8 ServerActiveSlot)
+{
+	ActiveSlot = ServerActiveSlot;
+	RefreshEquippedWeapon();
+}
+
+void UCombatComponent::EquipButtonPressed()
+{
+	if (Character == nullptr) return;
+
+	if (Character->HasAuthority())
+	{
+		ServerHandleEquip();
+	}
+	else
+	{
+		++LocalInputState.EquipCount;
+		MarkInputStateDirty();
+	}
+}
+
+void UCombatComponent::ServerHandleEquip()
+{
+	if (Character) EquipWeapon(Character->GetOverlappingWeapon());
 }
 
 void UCombatComponent::ReloadButtonPressed()
 {
 	if (CarriedAmmo > 0 && CombatState != ECombatState::ECS_Reloading)
 	{
-		ServerReload();
+		if (Character && Character->HasAuthority())
+		{
+			ServerHandleReload();
+		}
+		else
+		{
+			++LocalInputState.ReloadCount;
+			MarkInputStateDirty();
+		}
 	}
 }
 
-void UCombatComponent::ServerReload_Implementation()
+void UCombatComponent::ServerHandleReload()
 {
+	if (CarriedAmmo <= 0 || CombatState == ECombatState::ECS_Reloading) return;
+
 	CombatState = ECombatState::ECS_Reloading;
+	UBlasterEventLogSubsystem::Record(Character, EBlasterGameplayEvent::EBGE_Reload, Character, nullptr, CarriedAmmo, Character ? Character->GetActorLocation() : FVector::ZeroVector);
 	HandleReload();
 }
 
@@ -135,21 +294,34 @@ void UCombatComponent::OnRep_CombatState()
 	}
 }
 
-void UCombatComponent::OnRep_EquippedWeapon()
+void UCombatComponent::OnRep_Inventory()
 {
-	if (EquippedWeapon && Character)
+	if (Character == nullptr) return;
+
+	bool bHasWeapon = false;
+	for (AWeapon* Weapon : Inventory)
 	{
-		EquippedWeapon->SetWeaponState(EWeaponState::EWS_Equipped);
-		const USkeletalMeshSocket* HandSocket = Character->GetMesh()->GetSocketByName(FName("RightHandSocket"));
-		if (HandSocket)
+		if (Weapon)
 		{
-			HandSocket->AttachActor(EquippedWeapon, Character->GetMesh());
+			Weapon->SetWeaponState(EWeaponState::EWS_Equipped);
+			AttachWeaponToHand(Weapon);
+			bHasWeapon = true;
 		}
+	}
+	RefreshEquippedWeapon();
+
+	if (bHasWeapon)
+	{
 		Character->GetCharacterMovement()->bOrientRotationToMovement = false;
 		Character->bUseControllerRotationYaw = true;
 	}
 }
 
+void UCombatComponent::OnRep_ActiveSlot()
+{
+	RefreshEquippedWeapon();
+}
+
 void UCombatComponent::FireButtonPressed(bool bInIsFireButtonPressed)
 {
 	bIsFireButtonPressed = bInIsFireButtonPressed;
@@ -163,54 +335,154 @@ void UCombatComponent::Fire()
 {
 	if (CanFire())
 	{
-		bIsFiring = true;
-		ServerFire(HitTarget);
-		if (EquippedWeapon)
-		{
-			CrosshairShootFactor = MaxCrosshairShootFactor;
-		}
-		FireTimerStart();
+		FireShot(0.f);
 	}
 }
 
+void UCombatComponent::FireShot(float TimeOffset)
+{
+	FireCooldown += EquippedWeapon->FireDelay;
+
+	// The server counts the shots in each input state, so it can reproduce the seed without extra bytes
+	++LocalInputState.FireCount;
+	const uint32 SpreadSeed = FWeaponSpreadModel::GetShotSeed(++ShotsFired, ShotSeedSalt);
+	if (Character && Character->IsLocallyControlled() && Character->Controller)
+	{
+		// The server sees the kick through the control rotation the client sends with its moves
+		Character->Controller->SetControlRotation(Character->Controller->GetControlRotation() + FWeaponSpreadModel::GetShotRecoil(SpreadSeed, GetSpreadParams()));
+	}
+
+	if (Character && Character->HasAuthority())
+	{
+		FWeaponFireParams Params;
+		Params.HitTarget = HitTarget;
+		Params.TimeOffset = TimeOffset;
+		Params.Spread = SpreadModel.GetSpread(GetSpreadParams(), TimeOffset);
+		Params.SpreadSeed = SpreadSeed;
+		ServerHandleFire(Params);
+	}
+	else
+	{
+		// The server works out the offsets of earlier shots from this one and the fire delay
+		LocalInputState.HitTarget = HitTarget;
+		LocalInputState.LastShotTimeOffset = TimeOffset;
+		MarkInputStateDirty();
+	}
+	SpreadModel.AddShot(TimeOffset);
+}
+
+void UCombatComponent::UpdateFireScheduler(float DeltaTime)
+{
+	FireCooldown -= DeltaTime;
+
+	// Emit every shot that came due during this frame. A negative cooldown is how long before the end of the frame the shot was due
+	int32 NumShots = 0;
+	while (bIsFireButtonPressed && EquippedWeapon && EquippedWeapon->bIsAutomatic && NumShots < MaxShotsPerFrame && CanFire())
+	{
+		FireShot(FMath::Min(-FireCooldown, FWeaponFireParams::MaxTimeOffset));
+		++NumShots;
+	}
+
+	// Time spent not firing is not banked for later shots
+	FireCooldown = FMath::Max(FireCooldown, 0.f);
+}
+
 bool UCombatComponent::CanFire() const
 {
 	if (EquippedWeapon)
 	{
-		return EquippedWeapon->CanFire() && !bIsFiring;
+		return EquippedWeapon->CanFire() && FireCooldown <= 0.f;
 	}
 	return false;
 }
 
-void UCombatComponent::ServerFire_Implementation(const FVector_NetQuantize& TraceHitTarget)
+void UCombatComponent::ServerHandleFire(const FWeaponFireParams& Params)
 {
-	MulticastFire(TraceHitTarget);
+	UBlasterEventLogSubsystem::Record(Character, EBlasterGameplayEvent::EBGE_Fire, Character, nullptr, 0.f, Params.HitTarget);
+
+	FWeaponFireParams MulticastParams = Params;
+	if (EquippedWeapon)
+	{
+		EquippedWeapon->PrepareFire(MulticastParams);
+	}
+	MulticastFire(MulticastParams);
 }
 
-void UCombatComponent::MulticastFire_Implementation(const FVector_NetQuantize& TraceHitTarget)
+void UCombatComponent::MarkInputStateDirty()
 {
-	if (EquippedWeapon == nullptr) return;
-	if (Character)
+	++LocalInputState.Sequence;
+	InputStateSendsRemaining = FMath::Max(InputStateRedundantSends, 1);
+}
+
+void UCombatComponent::FlushInputState()
+{
+	// Keep sending until the server confirms the predicted swap, since losing every redundant send would leave it uncorrected
+	if (LocalInputState.SwapCount != AckedSwapCount)
 	{
-		Character->PlayFireMontage(bIsAiming);
-		EquippedWeapon->Fire(TraceHitTarget);
+		InputStateSendsRemaining = FMath::Max(InputStateSendsRemaining, 1);
 	}
+
+	// At most one input state per frame, no matter how many presses happened since the last one
+	if (InputStateSendsRemaining <= 0) return;
+
+	--InputStateSendsRemaining;
+	ServerSendInputState(LocalInputState);
 }
 
-void UCombatComponent::FireTimerStart()
+void UCombatComponent::ServerSendInputState_Implementation(const FBlasterInputState& InputState)
 {
-	if (EquippedWeapon == nullptr || Character == nullptr) return;
+	// Drop packets older than the last state we processed
+	if (static_cast<int8>(InputState.Sequence - LastServerInputState.Sequence) <= 0) return;
 
-	Character->GetWorldTimerManager().SetTimer(FireTimer, this, &UCombatComponent::FireTimerFinish, EquippedWeapon->FireDelay);
+	const uint8 NewShots = InputState.FireCount - LastServerInputState.FireCount;
+	const uint8 NewReloads = (InputState.ReloadCount - LastServerInputState.ReloadCount) & FBlasterInputState::PressCounterMask;
+	const uint8 NewEquips = (InputState.EquipCount - LastServerInputState.EquipCount) & FBlasterInputState::PressCounterMask;
+	const uint8 NewSwaps = (InputState.SwapCount - LastServerInputState.SwapCount) & FBlasterInputState::PressCounterMask;
+	LastServerInputState = InputState;
+
+	if (NewEquips > 0)
+	{
+		ServerHandleEquip();
+	}
+	if (NewSwaps > 0)
+	{
+		if (!ServerHandleSwap(InputState.SwapSlot))
+		{
+			// ActiveSlot did not change, so replication alone would never correct the client's prediction
+			ClientRejectSwap(ActiveSlot);
+		}
+		AckedSwapCount = InputState.SwapCount;
+	}
+	if (NewReloads > 0)
+	{
+		ServerHandleReload();
+	}
+	// Only the newest shots are fired when over the limit, but every shot advances the index so the seeds stay in step with the client's
+	const uint8 NumShots = FMath::Min(NewShots, MaxShotsPerInputState);
+	const uint32 FirstShotIndex = ShotsFired + 1 + (NewShots - NumShots);
+	ShotsFired += NewShots;
+
+	// Shots batched into one input state were spaced by the fire delay on the client, before the newest one's sub-frame offset
+	const float FireDelay = EquippedWeapon ? EquippedWeapon->FireDelay : 0.f;
+	for (uint8 Shot = 0; Shot < NumShots; ++Shot)
+	{
+		FWeaponFireParams Params;
+		Params.HitTarget = InputState.HitTarget;
+		Params.TimeOffset = FMath::Min(InputState.LastShotTimeOffset + (NumShots - 1 - Shot) * FireDelay, FWeaponFireParams::MaxTimeOffset);
+		Params.Spread = SpreadModel.GetSpread(GetSpreadParams(), Params.TimeOffset);
+		Params.SpreadSeed = FWeaponSpreadModel::GetShotSeed(FirstShotIndex + Shot, ShotSeedSalt);
+		SpreadModel.AddShot(Params.TimeOffset);
+		ServerHandleFire(Params);
+	}
 }
 
-void UCombatComponent::FireTimerFinish()
+void UCombatComponent::MulticastFire_Implementation(const FWeaponFireParams& Params)
 {
 	if (EquippedWeapon == nullptr) return;
-	bIsFiring = false;
-	if (bIsFireButtonPressed && EquippedWeapon->bIsAutomatic)
+	if (Character)
 	{
-		Fire();
+		Character->PlayFireMontage(bIsAiming);
+		EquippedWeapon->Fire(Params);
 	}
 }
 
@@ -262,24 +534,22 @@ void UCombatComponent::TraceUnderCrosshairs(FHitResult& TraceHitResult)
 
 void UCombatComponent::SetAiming(bool bInIsAiming)
 {
-	// First make changes on client so that client sees immediate response to action
+	// Make changes locally so that the client sees an immediate response to the action
 	bIsAiming = bInIsAiming;
-	if (Character && EquippedWeapon)
+
+	// The movement component saves the aiming state with each move, which predicts the walk speed and informs the server
+	if (Character)
 	{
-		Character->GetCharacterMovement()->MaxWalkSpeed = bIsAiming ? AimWalkSpeed : BaseWalkSpeed;
+		if (UBlasterCharacterMovementComponent* BlasterMovement = Character->GetBlasterCharacterMovement())
+		{
+			BlasterMovement->SetWantsToAim(bIsAiming && EquippedWeapon);
+		}
 	}
-
-	// Then send an RPC to server
-	ServerSetAiming(bIsAiming);
 }
 
-void UCombatComponent::ServerSetAiming_Implementation(bool bInIsAiming)
+void UCombatComponent::SetAimingFromMovement(bool bInIsAiming)
 {
 	bIsAiming = bInIsAiming;
-	if (Character && EquippedWeapon)
-	{
-		Character->GetCharacterMovement()->MaxWalkSpeed = bIsAiming ? AimWalkSpeed : BaseWalkSpeed;
-	}
 }
 
 void UCombatComponent::UpdateHUDCrosshairs(float DeltaTime)
@@ -309,47 +579,26 @@ void UCombatComponent::UpdateHUDCrosshairs(float DeltaTime)
 				HUDPackage.CrosshairsTop = nullptr;
 				HUDPackage.CrosshairsBottom = nullptr;
 			}
-			UpdateCrosshairVelocityFactor(DeltaTime);
-			UpdateCrosshairInAirFactor(DeltaTime);
-			UpdateCrosshairAimFactor(DeltaTime);
-			UpdateCrosshairShootFactor(DeltaTime);
-
-			HUDPackage.CrosshairSpread = CrosshairBaselineSpread +
-				CrosshairVelocityFactor +
-				CrosshairInAirFactor +
-				CrosshairAimFactor +
-				CrosshairShootFactor;
+			HUDPackage.CrosshairSpread = SpreadModel.GetSpread(GetSpreadParams());
 
 			HUD->SetHUDPackage(HUDPackage);
 		}
 	}
 }
 
-void UCombatComponent::UpdateCrosshairVelocityFactor(float DeltaTime)
+void UCombatComponent::UpdateSpreadModel(float DeltaTime)
 {
-	const FVector2D WalkSpeedRange(0.f, Character->GetCharacterMovement()->MaxWalkSpeed);
-	const FVector2D VelocityMultiplierRange(0.f, MaxCrosshairVelocityFactor);
 	FVector Velocity = Character->GetVelocity();
 	Velocity.Z = 0.f;
-	CrosshairVelocityFactor = FMath::GetMappedRangeValueClamped(WalkSpeedRange, VelocityMultiplierRange, Velocity.Size());
-}
-
-void UCombatComponent::UpdateCrosshairInAirFactor(float DeltaTime)
-{
-	float TargetFactor = Character->GetCharacterMovement()->IsFalling() ? MaxCrosshairInAirFactor : 0.f;
-	float InterpSpeed = Character->GetCharacterMovement()->IsFalling() ? 2.25f : 30.f;
-	CrosshairInAirFactor = FMath::FInterpTo(CrosshairInAirFactor, TargetFactor, DeltaTime, InterpSpeed);
-}
-
-void UCombatComponent::UpdateCrosshairAimFactor(float DeltaTime)
-{
-	float TargetFactor = bIsAiming ? MaxCrosshairAimFactor : 0.f;
-	CrosshairAimFactor = FMath::FInterpTo(CrosshairAimFactor, TargetFactor, DeltaTime, 30.f);
+	const UCharacterMovementComponent* Movement = Character->GetCharacterMovement();
+	// The movement component's speed for the current mode, which is the aim speed while aiming
+	SpreadModel.Update(DeltaTime, Velocity.Size(), Movement->GetMaxSpeed(), Movement->IsFalling(), bIsAiming, GetSpreadParams());
 }
 
-void UCombatComponent::UpdateCrosshairShootFactor(float DeltaTime)
+const FWeaponSpreadParams& UCombatComponent::GetSpreadParams() const
 {
-	CrosshairShootFactor = FMath::FInterpTo(CrosshairShootFactor, 0.f, DeltaTime, 30.f);
+	static const FWeaponSpreadParams DefaultSpreadParams;
+	return EquippedWeapon ? EquippedWeapon->GetSpreadParams() : DefaultSpreadParams;
 }
 
 void UCombatComponent::UpdateCameraFOV(float DeltaTime)
@@ -382,5 +631,5 @@ void UCombatComponent::OnRep_CarriedAmmo()
 
 void UCombatComponent::InitializeCarriedAmmo()
 {
-	CarriedAmmoMap.Emplace(EWeaponType::EWT_AssaultRifle, StartingARAmmo);
+	CarriedAmmoByType[static_cast<uint8>(EWeaponType::EWT_AssaultRifle)] = StartingARAmmo;
 }
@@ -46,7 +46,7 @@ void UBlasterAnimInstance::NativeUpdateAnimation(float DeltaTime)
 	bIsEliminated = BlasterCharacter->IsEliminated();
 
 	// Yaw Offset for strafing
-	const FRotator AimRotation = BlasterCharacter->GetBaseAimRotation();
+	const FRotator AimRotation = BlasterCharacter->GetAimRotation();
 	const FRotator MovementRotation = UKismetMathLibrary::MakeRotFromX(BlasterCharacter->GetVelocity());
 	YawOffset = UKismetMathLibrary::NormalizedDeltaRotator(MovementRotation, AimRotation).Yaw;
 
@@ -4,6 +4,7 @@
 #include "Character/BlasterCharacter.h"
 
 #include "Blaster/Blaster.h"
+#include "BlasterComponents/BlasterCharacterMovementComponent.h"
 #include "BlasterComponents/CombatComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Character/BlasterAnimInstance.h"
@@ -18,11 +19,14 @@
 #include "Net/UnrealNetwork.h"
 #include "PlayerController/BlasterPlayerController.h"
 #include "PlayerState/BlasterPlayerState.h"
+#include "Subsystems/BlasterDamageSubsystem.h"
+#include "Subsystems/BlasterEventLogSubsystem.h"
 #include "TimerManager.h"
 #include "Weapon/Weapon.h"
 #include "Weapon/WeaponTypes.h"
 
-ABlasterCharacter::ABlasterCharacter()
+ABlasterCharacter::ABlasterCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UBlasterCharacterMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -56,6 +60,13 @@ ABlasterCharacter::ABlasterCharacter()
 	GetMesh()->SetCollisionResponseToChannel(ECC_Visibility, ECR_Block);
 	GetCapsuleComponent()->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
 
+	// Hit regions of the default mannequin skeleton
+	HitRegionBones.Add("neck_01", EHitRegion::EHR_Head);
+	HitRegionBones.Add("clavicle_l", EHitRegion::EHR_Arms);
+	HitRegionBones.Add("clavicle_r", EHitRegion::EHR_Arms);
+	HitRegionBones.Add("thigh_l", EHitRegion::EHR_Legs);
+	HitRegionBones.Add("thigh_r", EHitRegion::EHR_Legs);
+
 	// Dissolve timeline
 	DissolveTimeline = CreateDefaultSubobject<UTimelineComponent>("DissolveTimelineComponent");
 
@@ -81,6 +92,22 @@ void ABlasterCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& Ou
 	// Register replicated variables
 	DOREPLIFETIME_CONDITION(ABlasterCharacter, OverlappingWeapon, COND_OwnerOnly);
 	DOREPLIFETIME(ABlasterCharacter, Health);
+	DOREPLIFETIME(ABlasterCharacter, LastHitInfo);
+	DOREPLIFETIME_CONDITION(ABlasterCharacter, AimState, COND_SimulatedOnly);
+
+	// AimState carries the pitch for simulated proxies
+	DISABLE_REPLICATED_PROPERTY(APawn, RemoteViewPitch);
+}
+
+void ABlasterCharacter::PostNetReceiveLocationAndRotation()
+{
+	Super::PostNetReceiveLocationAndRotation();
+
+	// The replicated movement's yaw is the aim yaw, buffered alongside the pitch from AimState
+	if (GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		AimYawBuffer.AddSample(GetSyncedServerTime(), GetActorRotation().Yaw);
+	}
 }
 
 void ABlasterCharacter::BeginPlay()
@@ -93,6 +120,7 @@ void ABlasterCharacter::BeginPlay()
 	// Bind delegates
 	if (HasAuthority())
 	{
+		OnTakePointDamage.AddDynamic(this, &ABlasterCharacter::ReceivePointDamage);
 		OnTakeAnyDamage.AddDynamic(this, &ABlasterCharacter::ReceiveDamage);
 	}
 
@@ -116,6 +144,7 @@ void ABlasterCharacter::Tick(float DeltaTime)
 	PollInit();
 
 	// Update character properties
+	UpdateReplicatedAim();
 	AimOffset(DeltaTime);
 	TurnInPlace(DeltaTime);
 	HideCharacterIfCameraClose();
@@ -166,24 +195,7 @@ void ABlasterCharacter::Look(const FInputActionValue& InputActionValue)
 
 void ABlasterCharacter::EquipButtonPressed(const FInputActionValue& InputActionValue)
 {
-	if (Combat)
-	{
-		if (HasAuthority())
-		{
-			// Server
-			Combat->EquipWeapon(OverlappingWeapon);
-		}
-		else
-		{
-			// Client
-			ServerEquipButtonPressed();
-		}
-	}
-}
-
-void ABlasterCharacter::ServerEquipButtonPressed_Implementation()
-{
-	if (Combat) Combat->EquipWeapon(OverlappingWeapon);
+	if (Combat) Combat->EquipButtonPressed();
 }
 
 void ABlasterCharacter::CrouchButtonPressed(const FInputActionValue& InputActionValue)
@@ -216,6 +228,11 @@ void ABlasterCharacter::ReloadButtonPressed(const FInputActionValue& InputAction
 	if (Combat) Combat->ReloadButtonPressed();
 }
 
+void ABlasterCharacter::SwapWeaponButtonPressed(const FInputActionValue& InputActionValue)
+{
+	if (Combat) Combat->SwapWeaponButtonPressed();
+}
+
 void ABlasterCharacter::AimOffset(float DeltaTime)
 {
 	if (Combat->EquippedWeapon == nullptr) return;
@@ -230,7 +247,7 @@ void ABlasterCharacter::AimOffset(float DeltaTime)
 	{
 		bUseControllerRotationYaw = true;
 
-		FRotator CurrentAimRotation = FRotator(0.f, GetBaseAimRotation().Yaw, 0.f);
+		FRotator CurrentAimRotation = FRotator(0.f, GetAimRotation().Yaw, 0.f);
 		FRotator DeltaAimRotation = UKismetMathLibrary::NormalizedDeltaRotator(CurrentAimRotation, StartingAimRotation);
 		AO_Yaw = DeltaAimRotation.Yaw;
 		if (TurningInPlaceState == ETurningInPlace::ETIP_NotTurning)
@@ -242,20 +259,58 @@ void ABlasterCharacter::AimOffset(float DeltaTime)
 	{
 		bUseControllerRotationYaw = true;
 
-		StartingAimRotation = FRotator(0.f, GetBaseAimRotation().Yaw, 0.f);
+		StartingAimRotation = FRotator(0.f, GetAimRotation().Yaw, 0.f);
 		AO_Yaw = 0.f;
 	}
 
-	// Pitch is always updated
-	float AO_PitchTarget = GetBaseAimRotation().Pitch;
-	if (!IsLocallyControlled() && AO_PitchTarget > 90.f)
+	// Pitch is always updated. Simulated proxies are already smoothed by the aim interpolation buffer
+	const float AO_PitchTarget = GetAimRotation().Pitch;
+	if (GetLocalRole() == ROLE_SimulatedProxy)
+	{
+		AO_Pitch = AO_PitchTarget;
+	}
+	else
+	{
+		AO_Pitch = FMath::FInterpTo(AO_Pitch, AO_PitchTarget, DeltaTime, 10.f);
+	}
+}
+
+FRotator ABlasterCharacter::GetAimRotation() const
+{
+	if (GetLocalRole() == ROLE_SimulatedProxy && HasInterpolatedAim())
+	{
+		return InterpolatedAimRotation;
+	}
+
+	FRotator AimRotation = GetBaseAimRotation();
+	AimRotation.Pitch = FRotator::NormalizeAxis(AimRotation.Pitch);
+	return AimRotation;
+}
+
+void ABlasterCharacter::UpdateReplicatedAim()
+{
+	if (HasAuthority())
+	{
+		AimState.Set(GetBaseAimRotation());
+	}
+	else if (GetLocalRole() == ROLE_SimulatedProxy && HasInterpolatedAim())
 	{
-		// Remap replicated pitch value to the original range
-		const FVector2D InRange(270.f, 360.f);
-		const FVector2D OutRange(-90.f, 0.f);
-		AO_PitchTarget = FMath::GetMappedRangeValueClamped(InRange, OutRange, AO_PitchTarget);
+		const double SampleTime = GetSyncedServerTime() - AimInterpolationDelay;
+		InterpolatedAimRotation.Yaw = AimYawBuffer.IsEmpty() ? GetActorRotation().Yaw : AimYawBuffer.Sample(SampleTime);
+		InterpolatedAimRotation.Pitch = AimPitchBuffer.IsEmpty() ? AimState.GetPitch() : AimPitchBuffer.Sample(SampleTime);
 	}
-	AO_Pitch = FMath::FInterpTo(AO_Pitch, AO_PitchTarget, DeltaTime, 10.f);
+}
+
+void ABlasterCharacter::OnRep_AimState()
+{
+	AimPitchBuffer.AddSample(GetSyncedServerTime(), AimState.GetPitch());
+}
+
+double ABlasterCharacter::GetSyncedServerTime() const
+{
+	// Simulated proxies have no controller of their own, so use the local player's
+	const ABlasterPlayerController* LocalPlayerController = Cast<ABlasterPlayerController>(GetWorld()->GetFirstPlayerController());
+	return LocalPlayerController ? LocalPlayerController->GetServerTime() : GetWorld()->GetTimeSeconds();
 }
 
 void ABlasterCharacter::TurnInPlace(float DeltaTime)
@@ -280,7 +335,7 @@ void ABlasterCharacter::TurnInPlace(float DeltaTime)
 		if (FMath::Abs(AO_Yaw) < 15.f)
 		{
 			TurningInPlaceState = ETurningInPlace::ETIP_NotTurning;
-			StartingAimRotation = FRotator(0.f, GetBaseAimRotation().Yaw, 0.f);
+			StartingAimRotation = FRotator(0.f, GetAimRotation().Yaw, 0.f);
 		}
 	}
 }
@@ -380,8 +435,22 @@ void ABlasterCharacter::PlayHitReactMontage()
 	if (AnimInstance && HitReactMontage && !AnimInstance->IsAnyMontagePlaying())
 	{
 		AnimInstance->Montage_Play(HitReactMontage);
-		FName SectionName("FromFront");
-		AnimInstance->Montage_JumpToSection(SectionName);
+		AnimInstance->Montage_JumpToSection(GetHitReactSectionName());
+	}
+}
+
+FName ABlasterCharacter::GetHitReactSectionName() const
+{
+	switch (BlasterHitInfo::GetDirection(LastHitInfo))
+	{
+	case EHitDirection::EHD_Back:
+		return FName("FromBack");
+	case EHitDirection::EHD_Left:
+		return FName("FromLeft");
+	case EHitDirection::EHD_Right:
+		return FName("FromRight");
+	default:
+		return FName("FromFront");
 	}
 }
 
@@ -396,7 +465,11 @@ void ABlasterCharacter::PlayElimMontage()
 
 void ABlasterCharacter::ReceiveDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* InstigatorController, AActor* DamageCauser)
 {
+	// Damage queued in the same frame as the elimination is ignored
+	if (bIsEliminated) return;
+
 	Health = FMath::Clamp(Health - Damage, 0.f, MaxHealth);
+	UBlasterEventLogSubsystem::Record(this, EBlasterGameplayEvent::EBGE_Damage, this, InstigatorController, Damage, GetActorLocation());
 	OnRep_Health();
 
 	if (Health <= 0.f)
@@ -410,6 +483,48 @@ void ABlasterCharacter::ReceiveDamage(AActor* DamagedActor, float Damage, const
 	}
 }
 
+void ABlasterCharacter::ReceivePointDamage(AActor* DamagedActor, float Damage, AController* InstigatedBy, FVector HitLocation, UPrimitiveComponent* FHitComponent, FName BoneName, FVector ShotFromDirection, const UDamageType* DamageType, AActor* DamageCauser)
+{
+	if (bIsEliminated) return;
+
+	const EHitRegion Region = UBlasterDamageSubsystem::GetHitRegion(FHitComponent, BoneName);
+
+	// The shot travels along ShotFromDirection, so the shooter is in the opposite direction
+	const FVector ToShooter = GetActorRotation().UnrotateVector(-ShotFromDirection);
+	const float Angle = FMath::RadiansToDegrees(FMath::Atan2(ToShooter.Y, ToShooter.X));
+	EHitDirection Direction = EHitDirection::EHD_Front;
+	if (FMath::Abs(Angle) >= 135.f)
+	{
+		Direction = EHitDirection::EHD_Back;
+	}
+	else if (Angle > 45.f)
+	{
+		Direction = EHitDirection::EHD_Right;
+	}
+	else if (Angle < -45.f)
+	{
+		Direction = EHitDirection::EHD_Left;
+	}
+
+	LastHitInfo = BlasterHitInfo::Pack(Region, Direction);
+	UBlasterEventLogSubsystem::Record(this, EBlasterGameplayEvent::EBGE_Hit, this, InstigatedBy, Damage, HitLocation, LastHitInfo);
+}
+
+float ABlasterCharacter::GetHitRegionDamageMultiplier(EHitRegion Region) const
+{
+	switch (Region)
+	{
+	case EHitRegion::EHR_Head:
+		return HeadDamageMultiplier;
+	case EHitRegion::EHR_Arms:
+		return ArmsDamageMultiplier;
+	case EHitRegion::EHR_Legs:
+		return LegsDamageMultiplier;
+	default:
+		return TorsoDamageMultiplier;
+	}
+}
+
 void ABlasterCharacter::SetOverlappingWeapon(AWeapon* Weapon)
 {
 	if (IsLocallyControlled()) // Only true on the server for the server's character
@@ -452,9 +567,9 @@ FVector ABlasterCharacter::GetHitTarget() const
 
 void ABlasterCharacter::Elim()
 {
-	if (Combat && Combat->EquippedWeapon)
+	if (Combat)
 	{
-		Combat->EquippedWeapon->Dropped();
+		Combat->DropWeapons();
 	}
 	MulticastElim();
 
@@ -466,6 +581,11 @@ ECombatState ABlasterCharacter::GetCombatState() const
 	return Combat ? Combat->CombatState : ECombatState::ECS_MAX;
 }
 
+UBlasterCharacterMovementComponent* ABlasterCharacter::GetBlasterCharacterMovement() const
+{
+	return Cast<UBlasterCharacterMovementComponent>(GetCharacterMovement());
+}
+
 void ABlasterCharacter::MulticastElim_Implementation()
 {
 	if (BlasterPlayerController)
@@ -574,5 +694,9 @@ void ABlasterCharacter::SetupPlayerInputComponent(UInputComponent* PlayerInputCo
 	EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &ABlasterCharacter::FireButtonPressed);
 	EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Completed, this, &ABlasterCharacter::FireButtonReleased);
 	EnhancedInputComponent->BindAction(ReloadAction, ETriggerEvent::Completed, this, &ABlasterCharacter::ReloadButtonPressed);
+	if (SwapWeaponAction)
+	{
+		EnhancedInputComponent->BindAction(SwapWeaponAction, ETriggerEvent::Started, this, &ABlasterCharacter::SwapWeaponButtonPressed);
+	}
 }
 
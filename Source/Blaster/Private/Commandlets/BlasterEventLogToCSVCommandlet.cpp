@@ -0,0 +1,76 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Commandlets/BlasterEventLogToCSVCommandlet.h"
+
+#include "Blaster/BlasterTypes/GameplayEvent.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBlasterEventLogToCSV, Log, All);
+
+int32 UBlasterEventLogToCSVCommandlet::Main(const FString& Params)
+{
+	FString InputFilename;
+	if (!FParse::Value(*Params, TEXT("Input="), InputFilename))
+	{
+		UE_LOG(LogBlasterEventLogToCSV, Error, TEXT("Usage: -run=BlasterEventLogToCSV -Input=<Log.blev> [-Output=<Log.csv>]"));
+		return 1;
+	}
+	FString OutputFilename;
+	if (!FParse::Value(*Params, TEXT("Output="), OutputFilename))
+	{
+		OutputFilename = FPaths::ChangeExtension(InputFilename, TEXT("csv"));
+	}
+
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *InputFilename))
+	{
+		UE_LOG(LogBlasterEventLogToCSV, Error, TEXT("Could not read %s"), *InputFilename);
+		return 1;
+	}
+
+	FMemoryReader Reader(Bytes);
+	FBlasterGameplayEventLogHeader Header;
+	Reader << Header;
+	if (Reader.IsError() || Header.Magic != FBlasterGameplayEventLogHeader::ExpectedMagic)
+	{
+		UE_LOG(LogBlasterEventLogToCSV, Error, TEXT("%s is not a Blaster event log"), *InputFilename);
+		return 1;
+	}
+	if (Header.Version != FBlasterGameplayEventLogHeader::CurrentVersion)
+	{
+		UE_LOG(LogBlasterEventLogToCSV, Error, TEXT("%s has version %u, this build reads version %u"), *InputFilename, Header.Version, FBlasterGameplayEventLogHeader::CurrentVersion);
+		return 1;
+	}
+
+	FString CSV(TEXT("Frame,Time,Event,Detail,PlayerId,OtherPlayerId,Value,X,Y,Z\n"));
+	int32 NumEvents = 0;
+	while (!Reader.AtEnd())
+	{
+		FBlasterGameplayEvent Event;
+		Reader << Event;
+		if (Reader.IsError())
+		{
+			// The server may have stopped in the middle of writing a batch
+			UE_LOG(LogBlasterEventLogToCSV, Warning, TEXT("%s ends with a truncated event"), *InputFilename);
+			break;
+		}
+
+		CSV += FString::Printf(TEXT("%u,%.3f,%s,%u,%d,%d,%.2f,%.1f,%.1f,%.1f\n"),
+			Event.Frame, Event.Time, LexToString(Event.Type), Event.Detail, Event.PlayerId, Event.OtherPlayerId, Event.Value,
+			Event.Location.X, Event.Location.Y, Event.Location.Z);
+		++NumEvents;
+	}
+
+	if (!FFileHelper::SaveStringToFile(CSV, *OutputFilename))
+	{
+		UE_LOG(LogBlasterEventLogToCSV, Error, TEXT("Could not write %s"), *OutputFilename);
+		return 1;
+	}
+
+	UE_LOG(LogBlasterEventLogToCSV, Display, TEXT("Wrote %d events from %s (%s, started %s) to %s"), NumEvents, *InputFilename, *Header.MapName,
+		*FDateTime(Header.StartTicks).ToString(), *OutputFilename);
+	return 0;
+}
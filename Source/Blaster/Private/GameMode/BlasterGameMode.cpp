@@ -5,9 +5,92 @@
 
 #include "Character/BlasterCharacter.h"
 #include "GameFramework/PlayerStart.h"
+#include "GameState/BlasterGameState.h"
 #include "Kismet/GameplayStatics.h"
 #include "PlayerController/BlasterPlayerController.h"
 #include "PlayerState/BlasterPlayerState.h"
+#include "Subsystems/BlasterEventLogSubsystem.h"
+#include "Subsystems/BlasterReplaySubsystem.h"
+#include "Subsystems/BlasterTravelTimingSubsystem.h"
+#include "TimerManager.h"
+
+namespace MatchState
+{
+	const FName Cooldown = FName(TEXT("Cooldown"));
+}
+
+ABlasterGameMode::ABlasterGameMode()
+{
+	GameStateClass = ABlasterGameState::StaticClass();
+
+	// The match is started by the warmup timer
+	bDelayedStart = true;
+}
+
+void ABlasterGameMode::GenericPlayerInitialization(AController* C)
+{
+	Super::GenericPlayerInitialization(C);
+
+	// Runs for new and seamlessly travelled players alike
+	ABlasterGameState* BlasterGameState = GetGameState<ABlasterGameState>();
+	if (BlasterGameState && C)
+	{
+		BlasterGameState->AddScoreboardEntry(C->PlayerState);
+	}
+}
+
+void ABlasterGameMode::PostSeamlessTravel()
+{
+	UBlasterTravelTimingSubsystem::Mark(this, TEXT("PostSeamlessTravel"));
+
+	Super::PostSeamlessTravel();
+
+	UBlasterTravelTimingSubsystem::Mark(this, TEXT("PostSeamlessTravelComplete"));
+}
+
+void ABlasterGameMode::OnMatchStateSet()
+{
+	Super::OnMatchStateSet();
+
+	if (MatchState == MatchState::WaitingToStart)
+	{
+		StartMatchPhase(WarmupTime, &ABlasterGameMode::WarmupFinished);
+	}
+	else if (MatchState == MatchState::InProgress)
+	{
+		StartMatchPhase(MatchTime, &ABlasterGameMode::MatchFinished);
+		UBlasterReplaySubsystem::StartMatchRecording(this);
+	}
+	else if (MatchState == MatchState::Cooldown)
+	{
+		StartMatchPhase(CooldownTime, &ABlasterGameMode::CooldownFinished);
+		UBlasterReplaySubsystem::StopMatchRecording(this);
+	}
+}
+
+void ABlasterGameMode::StartMatchPhase(float Duration, void (ABlasterGameMode::*OnPhaseFinished)())
+{
+	if (ABlasterGameState* BlasterGameState = GetGameState<ABlasterGameState>())
+	{
+		BlasterGameState->SetMatchPhase(GetWorld()->GetTimeSeconds(), Duration);
+	}
+	GetWorldTimerManager().SetTimer(MatchPhaseTimer, this, OnPhaseFinished, FMath::Max(Duration, KINDA_SMALL_NUMBER));
+}
+
+void ABlasterGameMode::WarmupFinished()
+{
+	StartMatch();
+}
+
+void ABlasterGameMode::MatchFinished()
+{
+	SetMatchState(MatchState::Cooldown);
+}
+
+void ABlasterGameMode::CooldownFinished()
+{
+	RestartGame();
+}
 
 void ABlasterGameMode::PlayerEliminated(ABlasterCharacter* ElimmedCharacter, ABlasterPlayerController* VictimController, ABlasterPlayerController* AttackerController)
 {
@@ -23,6 +106,12 @@ void ABlasterGameMode::PlayerEliminated(ABlasterCharacter* ElimmedCharacter, ABl
 		VictimPlayerState->AddToDeaths(1);
 	}
 
+	if (ABlasterGameState* BlasterGameState = GetGameState<ABlasterGameState>())
+	{
+		BlasterGameState->RecordElimination(AttackerPlayerState, VictimPlayerState);
+	}
+	UBlasterEventLogSubsystem::Record(this, EBlasterGameplayEvent::EBGE_Elimination, VictimPlayerState, AttackerPlayerState, 0.f, ElimmedCharacter ? ElimmedCharacter->GetActorLocation() : FVector::ZeroVector);
+
 	if (ElimmedCharacter)
 	{
 		ElimmedCharacter->Elim();
@@ -42,5 +131,6 @@ void ABlasterGameMode::RequestRespawn(ACharacter* ElimmedCharacter, AController*
 		UGameplayStatics::GetAllActorsOfClass(this, APlayerStart::StaticClass(), PlayerStarts);
 		int32 RandomIndex = FMath::RandRange(0, PlayerStarts.Num() - 1);
 		RestartPlayerAtPlayerStart(ElimmedController, PlayerStarts[RandomIndex]);
+		UBlasterEventLogSubsystem::Record(this, EBlasterGameplayEvent::EBGE_Respawn, ElimmedController, nullptr, 0.f, PlayerStarts[RandomIndex]->GetActorLocation());
 	}
 }
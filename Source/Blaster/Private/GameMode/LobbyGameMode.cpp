@@ -3,19 +3,174 @@
 
 #include "GameMode/LobbyGameMode.h"
 
+#include "Engine/GameInstance.h"
+#include "GameFramework/GameSession.h"
 #include "GameFramework/GameStateBase.h"
+#include "Kismet/GameplayStatics.h"
+#include "MultiplayerSessionsSubsystem.h"
+#include "PlayerController/BlasterPlayerController.h"
+#include "Subsystems/BlasterPreloadSubsystem.h"
+#include "Subsystems/BlasterTravelTimingSubsystem.h"
+#include "TimerManager.h"
+
+ALobbyGameMode::ALobbyGameMode()
+{
+	// The match map pulls in everything else it needs; the pawn, weapon and projectile are listed so they load first
+	PreloadAssets.Add(FSoftObjectPath(TEXT("/Game/Blueprints/Character/BP_BlasterCharacter.BP_BlasterCharacter_C")));
+	PreloadAssets.Add(FSoftObjectPath(TEXT("/Game/Blueprints/Weapon/BP_AssaultRifle.BP_AssaultRifle_C")));
+	PreloadAssets.Add(FSoftObjectPath(TEXT("/Game/Blueprints/Weapon/Projectiles/BP_ProjectileBullet.BP_ProjectileBullet_C")));
+	PreloadAssets.Add(FSoftObjectPath(TEXT("/Game/Blueprints/Weapon/Casings/BP_Casing.BP_Casing_C")));
+	PreloadAssets.Add(FSoftObjectPath(TEXT("/Game/Maps/BlasterMap.BlasterMap")));
+}
+
+void ALobbyGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	MinPlayers = FMath::Max(UGameplayStatics::GetIntOption(Options, TEXT("MinPlayers"), MinPlayers), 1);
+	if (UGameplayStatics::HasOption(Options, TEXT("LobbyTimeout")))
+	{
+		LobbyTimeout = FCString::Atof(*UGameplayStatics::ParseOption(Options, TEXT("LobbyTimeout")));
+	}
+	if (UGameplayStatics::HasOption(Options, TEXT("MatchType")))
+	{
+		MatchType = UGameplayStatics::ParseOption(Options, TEXT("MatchType"));
+	}
+
+	if (IsRunningDedicatedServer())
+	{
+		CreateDedicatedServerSession();
+	}
+}
+
+void ALobbyGameMode::CreateDedicatedServerSession()
+{
+	UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr;
+	if (MultiplayerSessionsSubsystem == nullptr || MultiplayerSessionsSubsystem->HasGameSession()) return;
+
+	const int32 NumPublicConnections = GameSession ? GameSession->MaxPlayers : 16;
+	MultiplayerSessionsSubsystem->CreateSession(NumPublicConnections, MatchType);
+}
 
 void ALobbyGameMode::PostLogin(APlayerController* NewPlayer)
 {
 	Super::PostLogin(NewPlayer);
 
+	// Late joiners still get the preload request
+	if (bPreloadStarted)
+	{
+		RequestClientPreload(NewPlayer);
+		return;
+	}
+
 	const int32 NumberOfPlayers = GameState->PlayerArray.Num();
-	if (NumberOfPlayers == 2)
+	if (NumberOfPlayers >= MinPlayers)
+	{
+		BeginPreload();
+	}
+	else if (NumberOfPlayers == 1 && LobbyTimeout > 0.f)
+	{
+		GetWorldTimerManager().SetTimer(LobbyTimer, this, &ALobbyGameMode::LobbyTimeoutExpired, LobbyTimeout);
+	}
+}
+
+void ALobbyGameMode::Logout(AController* Exiting)
+{
+	PendingPreloadPlayers.Remove(Cast<APlayerController>(Exiting));
+
+	Super::Logout(Exiting);
+
+	TryTravel();
+}
+
+void ALobbyGameMode::LobbyTimeoutExpired()
+{
+	if (!bPreloadStarted && GameState->PlayerArray.Num() > 0)
+	{
+		BeginPreload();
+	}
+}
+
+void ALobbyGameMode::BeginPreload()
+{
+	if (bPreloadStarted) return;
+	bPreloadStarted = true;
+	UBlasterTravelTimingSubsystem::Mark(this, TEXT("PreloadStart"));
+	GetWorldTimerManager().ClearTimer(LobbyTimer);
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		RequestClientPreload(It->Get());
+	}
+
+	UBlasterPreloadSubsystem* PreloadSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UBlasterPreloadSubsystem>() : nullptr;
+	if (PreloadSubsystem)
+	{
+		PreloadSubsystem->PreloadAssets(PreloadAssets, TravelMap, FSimpleDelegate::CreateUObject(this, &ALobbyGameMode::ServerPreloadComplete));
+	}
+	else
 	{
-		if (UWorld* World = GetWorld())
+		ServerPreloadComplete();
+	}
+
+	GetWorldTimerManager().SetTimer(PreloadTimer, this, &ALobbyGameMode::TravelToMatch, PreloadTimeout);
+}
+
+void ALobbyGameMode::RequestClientPreload(APlayerController* PlayerController)
+{
+	// Local controllers share the server's preload
+	ABlasterPlayerController* BlasterPlayerController = Cast<ABlasterPlayerController>(PlayerController);
+	if (BlasterPlayerController && !BlasterPlayerController->IsLocalController())
+	{
+		PendingPreloadPlayers.Add(BlasterPlayerController);
+		BlasterPlayerController->ClientPreloadAssets(PreloadAssets, TravelMap);
+	}
+}
+
+void ALobbyGameMode::PlayerPreloadComplete(APlayerController* PlayerController)
+{
+	PendingPreloadPlayers.Remove(PlayerController);
+	TryTravel();
+}
+
+void ALobbyGameMode::ServerPreloadComplete()
+{
+	bServerPreloadComplete = true;
+	UBlasterTravelTimingSubsystem::Mark(this, TEXT("ServerPreloadComplete"));
+	TryTravel();
+}
+
+void ALobbyGameMode::TryTravel()
+{
+	if (!bTravelling && bPreloadStarted && bServerPreloadComplete && PendingPreloadPlayers.IsEmpty())
+	{
+		TravelToMatch();
+	}
+}
+
+void ALobbyGameMode::TravelToMatch()
+{
+	if (bTravelling) return;
+
+	GetWorldTimerManager().ClearTimer(PreloadTimer);
+
+	if (UWorld* World = GetWorld())
+	{
+		bTravelling = true;
+		bUseSeamlessTravel = true;
+		UBlasterTravelTimingSubsystem::Mark(this, TEXT("ServerTravel"), TravelMap);
+		if (IsRunningDedicatedServer())
+		{
+			// Mark the session as in progress; a dedicated server is already listening
+			if (UMultiplayerSessionsSubsystem* MultiplayerSessionsSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UMultiplayerSessionsSubsystem>() : nullptr)
+			{
+				MultiplayerSessionsSubsystem->StartSession();
+			}
+			World->ServerTravel(TravelMap);
+		}
+		else
 		{
-			bUseSeamlessTravel = true;
-			World->ServerTravel(FString("/Game/Maps/BlasterMap?listen"));
+			World->ServerTravel(TravelMap + TEXT("?listen"));
 		}
 	}
 }
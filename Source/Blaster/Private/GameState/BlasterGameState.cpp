@@ -0,0 +1,198 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "GameState/BlasterGameState.h"
+
+#include "Algo/BinarySearch.h"
+#include "GameFramework/PlayerState.h"
+#include "Net/UnrealNetwork.h"
+#include "PlayerController/BlasterPlayerController.h"
+#include "TimerManager.h"
+
+namespace BlasterScoreboard
+{
+	// Leaderboard order: most kills, then fewest deaths, then lowest player id
+	static bool IsRankedBefore(const FBlasterScoreboardEntry& A, const FBlasterScoreboardEntry& B)
+	{
+		if (A.Kills != B.Kills) return A.Kills > B.Kills;
+		if (A.Deaths != B.Deaths) return A.Deaths < B.Deaths;
+		return A.PlayerId < B.PlayerId;
+	}
+}
+
+void FBlasterScoreboardEntry::PreReplicatedRemove(const FBlasterScoreboard& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnScoreboardEntryRemoved(*this);
+	}
+}
+
+void FBlasterScoreboardEntry::PostReplicatedAdd(const FBlasterScoreboard& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnScoreboardEntryChanged(*this);
+	}
+}
+
+void FBlasterScoreboardEntry::PostReplicatedChange(const FBlasterScoreboard& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->OnScoreboardEntryChanged(*this);
+	}
+}
+
+FBlasterScoreboardEntry* FBlasterScoreboard::FindEntry(int32 PlayerId)
+{
+	return Entries.FindByPredicate([PlayerId](const FBlasterScoreboardEntry& Entry) { return Entry.PlayerId == PlayerId; });
+}
+
+ABlasterGameState::ABlasterGameState()
+{
+	Scoreboard.Owner = this;
+}
+
+void ABlasterGameState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ABlasterGameState, Scoreboard);
+	DOREPLIFETIME(ABlasterGameState, PhaseStartTime);
+	DOREPLIFETIME(ABlasterGameState, PhaseDuration);
+}
+
+void ABlasterGameState::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (HasAuthority())
+	{
+		GetWorldTimerManager().SetTimer(PingUpdateTimer, this, &ABlasterGameState::UpdatePings, PingUpdateInterval, true);
+	}
+}
+
+void ABlasterGameState::OnRep_MatchState()
+{
+	Super::OnRep_MatchState();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		ABlasterPlayerController* BlasterPlayerController = Cast<ABlasterPlayerController>(It->Get());
+		if (BlasterPlayerController && BlasterPlayerController->IsLocalController())
+		{
+			BlasterPlayerController->OnMatchStateSet(MatchState);
+		}
+	}
+}
+
+void ABlasterGameState::SetMatchPhase(float StartTime, float Duration)
+{
+	PhaseStartTime = StartTime;
+	PhaseDuration = Duration;
+}
+
+void ABlasterGameState::AddScoreboardEntry(const APlayerState* PlayerState)
+{
+	if (HasAuthority() && PlayerState && Scoreboard.FindEntry(PlayerState->GetPlayerId()) == nullptr)
+	{
+		FBlasterScoreboardEntry& Entry = Scoreboard.Entries.AddDefaulted_GetRef();
+		Entry.PlayerId = PlayerState->GetPlayerId();
+		Entry.CompressedPing = PlayerState->GetCompressedPing();
+		MarkEntryDirty(Entry);
+	}
+}
+
+void ABlasterGameState::RemovePlayerState(APlayerState* PlayerState)
+{
+	if (HasAuthority() && PlayerState)
+	{
+		const int32 PlayerId = PlayerState->GetPlayerId();
+		const int32 Index = Scoreboard.Entries.IndexOfByPredicate([PlayerId](const FBlasterScoreboardEntry& Entry) { return Entry.PlayerId == PlayerId; });
+		if (Index != INDEX_NONE)
+		{
+			Scoreboard.Entries.RemoveAtSwap(Index);
+			Scoreboard.MarkArrayDirty();
+			RemoveLeaderboardEntry(PlayerId);
+			OnScoreboardChanged.Broadcast(PlayerId);
+		}
+	}
+
+	Super::RemovePlayerState(PlayerState);
+}
+
+void ABlasterGameState::RecordElimination(const APlayerState* AttackerPlayerState, const APlayerState* VictimPlayerState)
+{
+	if (!HasAuthority()) return;
+
+	if (AttackerPlayerState && AttackerPlayerState != VictimPlayerState)
+	{
+		if (FBlasterScoreboardEntry* AttackerEntry = Scoreboard.FindEntry(AttackerPlayerState->GetPlayerId()))
+		{
+			AttackerEntry->Kills++;
+			AttackerEntry->Streak++;
+			MarkEntryDirty(*AttackerEntry);
+		}
+	}
+	if (VictimPlayerState)
+	{
+		if (FBlasterScoreboardEntry* VictimEntry = Scoreboard.FindEntry(VictimPlayerState->GetPlayerId()))
+		{
+			VictimEntry->Deaths++;
+			VictimEntry->Streak = 0;
+			MarkEntryDirty(*VictimEntry);
+		}
+	}
+}
+
+void ABlasterGameState::OnScoreboardEntryChanged(const FBlasterScoreboardEntry& Entry)
+{
+	UpdateLeaderboardEntry(Entry);
+	OnScoreboardChanged.Broadcast(Entry.PlayerId);
+}
+
+void ABlasterGameState::OnScoreboardEntryRemoved(const FBlasterScoreboardEntry& Entry)
+{
+	RemoveLeaderboardEntry(Entry.PlayerId);
+	OnScoreboardChanged.Broadcast(Entry.PlayerId);
+}
+
+void ABlasterGameState::UpdateLeaderboardEntry(const FBlasterScoreboardEntry& Entry)
+{
+	RemoveLeaderboardEntry(Entry.PlayerId);
+	const int32 Index = Algo::LowerBound(Leaderboard, Entry, &BlasterScoreboard::IsRankedBefore);
+	Leaderboard.Insert(Entry, Index);
+}
+
+void ABlasterGameState::RemoveLeaderboardEntry(int32 PlayerId)
+{
+	const int32 Index = Leaderboard.IndexOfByPredicate([PlayerId](const FBlasterScoreboardEntry& Entry) { return Entry.PlayerId == PlayerId; });
+	if (Index != INDEX_NONE)
+	{
+		Leaderboard.RemoveAt(Index, 1, EAllowShrinking::No);
+	}
+}
+
+void ABlasterGameState::MarkEntryDirty(FBlasterScoreboardEntry& Entry)
+{
+	Scoreboard.MarkItemDirty(Entry);
+
+	// The server gets no replication callbacks, so update its leaderboard directly
+	OnScoreboardEntryChanged(Entry);
+}
+
+void ABlasterGameState::UpdatePings()
+{
+	for (const APlayerState* PlayerState : PlayerArray)
+	{
+		if (PlayerState == nullptr) continue;
+
+		FBlasterScoreboardEntry* Entry = Scoreboard.FindEntry(PlayerState->GetPlayerId());
+		if (Entry && Entry->CompressedPing != PlayerState->GetCompressedPing())
+		{
+			Entry->CompressedPing = PlayerState->GetCompressedPing();
+			MarkEntryDirty(*Entry);
+		}
+	}
+}
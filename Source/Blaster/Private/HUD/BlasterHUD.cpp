@@ -5,6 +5,7 @@
 
 #include "HUD/CharacterOverlay.h"
 #include "GameFramework/PlayerController.h"
+#include "Subsystems/BlasterTravelTimingSubsystem.h"
 
 void ABlasterHUD::DrawHUD()
 {
@@ -40,6 +41,7 @@ void ABlasterHUD::AddCharacterOverlay()
 	{
 		CharacterOverlay = CreateWidget<UCharacterOverlay>(PlayerController, CharacterOverlayClass);
 		CharacterOverlay->AddToViewport();
+		UBlasterTravelTimingSubsystem::Mark(this, TEXT("CharacterOverlayAdded"), FString(), true);
 	}
 }
 
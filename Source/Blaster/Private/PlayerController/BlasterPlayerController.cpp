@@ -6,8 +6,15 @@
 #include "Character/BlasterCharacter.h"
 #include "Components/ProgressBar.h"
 #include "Components/TextBlock.h"
+#include "Engine/GameInstance.h"
+#include "GameMode/BlasterGameMode.h"
+#include "GameMode/LobbyGameMode.h"
+#include "GameState/BlasterGameState.h"
 #include "HUD/BlasterHUD.h"
 #include "HUD/CharacterOverlay.h"
+#include "Subsystems/BlasterPreloadSubsystem.h"
+#include "Subsystems/BlasterTravelTimingSubsystem.h"
+#include "TimerManager.h"
 
 void ABlasterPlayerController::BeginPlay()
 {
@@ -16,16 +23,48 @@ void ABlasterPlayerController::BeginPlay()
 	BlasterHUD = Cast<ABlasterHUD>(GetHUD());
 }
 
+void ABlasterPlayerController::ReceivedPlayer()
+{
+	Super::ReceivedPlayer();
+
+	// Sync with the server clock as early as possible, then periodically to track drift
+	if (IsLocalController() && !HasAuthority())
+	{
+		RequestServerTime();
+		GetWorldTimerManager().SetTimer(TimeSyncTimer, this, &ABlasterPlayerController::RequestServerTime, TimeSyncFrequency, true);
+	}
+}
+
+void ABlasterPlayerController::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (IsLocalController())
+	{
+		UpdateHUDMatchCountdown();
+	}
+}
+
 void ABlasterPlayerController::OnPossess(APawn* InPawn)
 {
 	Super::OnPossess(InPawn);
 
+	UBlasterTravelTimingSubsystem::Mark(this, TEXT("FirstPawnPossessed"), GetNameSafe(InPawn), true);
+
 	if (ABlasterCharacter* BlasterCharacter = Cast<ABlasterCharacter>(InPawn))
 	{
 		SetHUDHealth(BlasterCharacter->GetHealth(), BlasterCharacter->GetMaxHealth());
 	}
 }
 
+void ABlasterPlayerController::AcknowledgePossession(APawn* P)
+{
+	Super::AcknowledgePossession(P);
+
+	// OnPossess only runs on the server, so clients mark their pawn here. A listen server's own marker is already taken
+	UBlasterTravelTimingSubsystem::Mark(this, TEXT("FirstPawnPossessed"), GetNameSafe(P), true);
+}
+
 void ABlasterPlayerController::SetHUDHealth(float Health, float MaxHealth)
 {
 	BlasterHUD = BlasterHUD == nullptr ? Cast<ABlasterHUD>(GetHUD()) : BlasterHUD;
@@ -88,3 +127,129 @@ void ABlasterPlayerController::SetHUDCarriedAmmo(int32 Ammo)
 		BlasterHUD->CharacterOverlay->CarriedAmmoAmount->SetText(FText::FromString(AmmoText));
 	}
 }
+
+void ABlasterPlayerController::SetHUDMatchCountdown(int32 SecondsRemaining)
+{
+	BlasterHUD = BlasterHUD == nullptr ? Cast<ABlasterHUD>(GetHUD()) : BlasterHUD;
+
+	const bool bHUDValid = BlasterHUD && BlasterHUD->CharacterOverlay && BlasterHUD->CharacterOverlay->MatchCountdownText;
+	if (bHUDValid)
+	{
+		const FString CountdownText = FString::Printf(TEXT("%02d:%02d"), SecondsRemaining / 60, SecondsRemaining % 60);
+		BlasterHUD->CharacterOverlay->MatchCountdownText->SetText(FText::FromString(CountdownText));
+	}
+}
+
+void ABlasterPlayerController::SetHUDMatchState(FName MatchState)
+{
+	BlasterHUD = BlasterHUD == nullptr ? Cast<ABlasterHUD>(GetHUD()) : BlasterHUD;
+
+	const bool bHUDValid = BlasterHUD && BlasterHUD->CharacterOverlay && BlasterHUD->CharacterOverlay->MatchStateText;
+	if (bHUDValid)
+	{
+		FString MatchStateText;
+		if (MatchState == MatchState::WaitingToStart)
+		{
+			MatchStateText = TEXT("Warmup");
+		}
+		else if (MatchState == MatchState::Cooldown)
+		{
+			MatchStateText = TEXT("Match Over");
+		}
+		BlasterHUD->CharacterOverlay->MatchStateText->SetText(FText::FromString(MatchStateText));
+	}
+}
+
+void ABlasterPlayerController::OnMatchStateSet(FName MatchState)
+{
+	SetHUDMatchState(MatchState);
+
+	// Force the countdown to refresh for the new phase
+	LastCountdownSeconds = INDEX_NONE;
+
+	if (MatchState == MatchState::Cooldown)
+	{
+		if (APawn* ControlledPawn = GetPawn())
+		{
+			ControlledPawn->DisableInput(this);
+		}
+	}
+}
+
+void ABlasterPlayerController::UpdateHUDMatchCountdown()
+{
+	const ABlasterGameState* BlasterGameState = GetWorld()->GetGameState<ABlasterGameState>();
+	if (BlasterGameState == nullptr) return;
+
+	const int32 SecondsRemaining = FMath::Max(FMath::CeilToInt(BlasterGameState->GetMatchPhaseTimeRemaining(GetServerTime())), 0);
+	if (SecondsRemaining != LastCountdownSeconds)
+	{
+		LastCountdownSeconds = SecondsRemaining;
+		SetHUDMatchCountdown(SecondsRemaining);
+	}
+}
+
+float ABlasterPlayerController::GetServerTime() const
+{
+	const float WorldTime = GetWorld()->GetTimeSeconds();
+	return HasAuthority() ? WorldTime : WorldTime + ClientServerDelta;
+}
+
+void ABlasterPlayerController::RequestServerTime()
+{
+	ServerRequestServerTime(GetWorld()->GetTimeSeconds());
+}
+
+void ABlasterPlayerController::ServerRequestServerTime_Implementation(float TimeOfClientRequest)
+{
+	ClientReportServerTime(TimeOfClientRequest, GetWorld()->GetTimeSeconds());
+}
+
+void ABlasterPlayerController::ClientReportServerTime_Implementation(float TimeOfClientRequest, float TimeServerReceivedClientRequest)
+{
+	const float CurrentTime = GetWorld()->GetTimeSeconds();
+	const float RoundTripTime = CurrentTime - TimeOfClientRequest;
+	const float CurrentServerTime = TimeServerReceivedClientRequest + 0.5f * RoundTripTime;
+
+	if (TimeSyncSamples.Num() == MaxTimeSyncSamples)
+	{
+		TimeSyncSamples.RemoveAt(0, 1, EAllowShrinking::No);
+	}
+	TimeSyncSamples.Add({ RoundTripTime, CurrentServerTime - CurrentTime });
+
+	const FTimeSyncSample* BestSample = &TimeSyncSamples[0];
+	for (const FTimeSyncSample& Sample : TimeSyncSamples)
+	{
+		if (Sample.RoundTripTime < BestSample->RoundTripTime)
+		{
+			BestSample = &Sample;
+		}
+	}
+	ClientServerDelta = BestSample->ClientServerDelta;
+}
+
+void ABlasterPlayerController::ClientPreloadAssets_Implementation(const TArray<FSoftObjectPath>& Assets, const FString& DestinationMapPackage)
+{
+	UBlasterPreloadSubsystem* PreloadSubsystem = GetGameInstance() ? GetGameInstance()->GetSubsystem<UBlasterPreloadSubsystem>() : nullptr;
+	if (PreloadSubsystem)
+	{
+		PreloadSubsystem->PreloadAssets(Assets, DestinationMapPackage, FSimpleDelegate::CreateUObject(this, &ABlasterPlayerController::ClientPreloadComplete));
+	}
+	else
+	{
+		ClientPreloadComplete();
+	}
+}
+
+void ABlasterPlayerController::ClientPreloadComplete()
+{
+	ServerReportPreloadComplete();
+}
+
+void ABlasterPlayerController::ServerReportPreloadComplete_Implementation()
+{
+	if (ALobbyGameMode* LobbyGameMode = GetWorld()->GetAuthGameMode<ALobbyGameMode>())
+	{
+		LobbyGameMode->PlayerPreloadComplete(this);
+	}
+}
@@ -0,0 +1,89 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterAudioSubsystem.h"
+
+#include "AudioDevice.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
+#include "Sound/SoundConcurrency.h"
+
+static TAutoConsoleVariable<int32> CVarBlasterAudioMaxSpawnsPerFrame(
+	TEXT("blaster.Audio.MaxSpawnsPerFrame"),
+	4,
+	TEXT("Maximum number of Blaster sounds of one category started per frame. 0: unlimited"),
+	ECVF_Scalability);
+
+namespace BlasterAudio
+{
+	struct FCategorySettings
+	{
+		const TCHAR* Name;
+
+		// Voices of this category playing at once
+		int32 MaxCount;
+
+		// Minimum time between two sounds of this category
+		float RetriggerTime;
+	};
+
+	static const FCategorySettings CategorySettings[] =
+	{
+		{ TEXT("Impact"), 8, 0.f },
+		{ TEXT("Casing"), 4, 0.05f },
+		{ TEXT("Gunfire"), 12, 0.f },
+	};
+	static_assert(UE_ARRAY_COUNT(CategorySettings) == static_cast<int32>(EBlasterSoundCategory::EBSC_MAX), "Every sound category needs concurrency settings");
+}
+
+void UBlasterAudioSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	for (const BlasterAudio::FCategorySettings& Settings : BlasterAudio::CategorySettings)
+	{
+		USoundConcurrency* Concurrency = NewObject<USoundConcurrency>(this, *FString::Printf(TEXT("BlasterConcurrency_%s"), Settings.Name), RF_Transient);
+		Concurrency->Concurrency.MaxCount = Settings.MaxCount;
+		Concurrency->Concurrency.RetriggerTime = Settings.RetriggerTime;
+		Concurrency->Concurrency.ResolutionRule = EMaxConcurrentResolutionRule::StopFarthestThenOldest;
+		CategoryConcurrency.Add(Concurrency);
+	}
+}
+
+bool UBlasterAudioSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBlasterAudioSubsystem::PlaySoundAtLocation(const UObject* WorldContextObject, USoundBase* Sound, const FVector& Location, EBlasterSoundCategory Category)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UBlasterAudioSubsystem* Audio = World ? World->GetSubsystem<UBlasterAudioSubsystem>() : nullptr;
+	if (!Sound || !Audio || World->GetNetMode() == NM_DedicatedServer) return;
+
+	// Skip sounds out of range of every listener instead of starting a virtual voice for them
+	const FAudioDeviceHandle AudioDevice = World->GetAudioDevice();
+	if (!AudioDevice || !AudioDevice->LocationIsAudible(Location, Sound->GetMaxDistance())) return;
+
+	if (!Audio->ConsumeSpawnBudget(Category)) return;
+
+	UGameplayStatics::PlaySoundAtLocation(World, Sound, Location, FRotator::ZeroRotator, 1.f, 1.f, 0.f, nullptr, Audio->CategoryConcurrency[static_cast<int32>(Category)]);
+}
+
+bool UBlasterAudioSubsystem::ConsumeSpawnBudget(EBlasterSoundCategory Category)
+{
+	if (SpawnBudgetFrame != GFrameCounter)
+	{
+		SpawnBudgetFrame = GFrameCounter;
+		FMemory::Memzero(SpawnsThisFrame);
+	}
+
+	const int32 MaxSpawnsPerFrame = CVarBlasterAudioMaxSpawnsPerFrame.GetValueOnGameThread();
+	int32& Spawns = SpawnsThisFrame[static_cast<int32>(Category)];
+	if (MaxSpawnsPerFrame > 0 && Spawns >= MaxSpawnsPerFrame) return false;
+
+	++Spawns;
+	return true;
+}
@@ -0,0 +1,188 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterDamageSubsystem.h"
+
+#include "Character/BlasterCharacter.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/PlayerState.h"
+#include "Kismet/GameplayStatics.h"
+
+void UBlasterDamageSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FlushDamage();
+}
+
+TStatId UBlasterDamageSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBlasterDamageSubsystem, STATGROUP_Tickables);
+}
+
+bool UBlasterDamageSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBlasterDamageSubsystem::QueueDamage(AActor* DamagedActor, float BaseDamage, AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass)
+{
+	if (!DamagedActor || BaseDamage == 0.f) return;
+
+	const UWorld* World = DamagedActor->GetWorld();
+	UBlasterDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UBlasterDamageSubsystem>() : nullptr;
+	if (DamageSubsystem == nullptr)
+	{
+		UGameplayStatics::ApplyDamage(DamagedActor, BaseDamage, EventInstigator, DamageCauser, DamageTypeClass);
+		return;
+	}
+
+	DamageSubsystem->AddPendingDamage(DamagedActor, BaseDamage, EventInstigator, DamageCauser, DamageTypeClass);
+}
+
+void UBlasterDamageSubsystem::QueuePointDamage(AActor* DamagedActor, float BaseDamage, const FVector& HitFromDirection, const FHitResult& HitInfo, AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass)
+{
+	if (!DamagedActor || BaseDamage == 0.f) return;
+
+	if (const ABlasterCharacter* BlasterCharacter = Cast<ABlasterCharacter>(DamagedActor))
+	{
+		BaseDamage *= BlasterCharacter->GetHitRegionDamageMultiplier(GetHitRegion(HitInfo.GetComponent(), HitInfo.BoneName));
+	}
+
+	const UWorld* World = DamagedActor->GetWorld();
+	UBlasterDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UBlasterDamageSubsystem>() : nullptr;
+	if (DamageSubsystem == nullptr)
+	{
+		UGameplayStatics::ApplyPointDamage(DamagedActor, BaseDamage, HitFromDirection, HitInfo, EventInstigator, DamageCauser, DamageTypeClass);
+		return;
+	}
+
+	FBlasterPendingDamage* Pending = DamageSubsystem->AddPendingDamage(DamagedActor, BaseDamage, EventInstigator, DamageCauser, DamageTypeClass);
+	Pending->bIsPointDamage = true;
+	Pending->HitFromDirection = HitFromDirection;
+	Pending->HitInfo = HitInfo;
+}
+
+EHitRegion UBlasterDamageSubsystem::GetHitRegion(const UPrimitiveComponent* HitComponent, FName BoneName)
+{
+	const USkeletalMeshComponent* MeshComponent = Cast<USkeletalMeshComponent>(HitComponent);
+	const ABlasterCharacter* BlasterCharacter = MeshComponent ? Cast<ABlasterCharacter>(MeshComponent->GetOwner()) : nullptr;
+	const UWorld* World = BlasterCharacter ? BlasterCharacter->GetWorld() : nullptr;
+	UBlasterDamageSubsystem* DamageSubsystem = World ? World->GetSubsystem<UBlasterDamageSubsystem>() : nullptr;
+	if (!DamageSubsystem || !MeshComponent || !MeshComponent->GetSkeletalMeshAsset()) return EHitRegion::EHR_Torso;
+
+	// The hit bone is the bone of the physics asset body that was struck
+	const int32 BoneIndex = MeshComponent->GetBoneIndex(BoneName);
+	const TArray<EHitRegion>& HitRegionTable = DamageSubsystem->FindOrBuildHitRegionTable(MeshComponent->GetSkeletalMeshAsset(), BlasterCharacter);
+	return HitRegionTable.IsValidIndex(BoneIndex) ? HitRegionTable[BoneIndex] : EHitRegion::EHR_Torso;
+}
+
+FBlasterPendingDamage* UBlasterDamageSubsystem::AddPendingDamage(AActor* DamagedActor, float BaseDamage, AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass)
+{
+	FBlasterPendingDamage& Pending = PendingDamage.AddDefaulted_GetRef();
+	Pending.DamagedActor = DamagedActor;
+	Pending.EventInstigator = EventInstigator;
+	Pending.DamageCauser = DamageCauser;
+	Pending.DamageTypeClass = DamageTypeClass;
+	Pending.BaseDamage = BaseDamage;
+	Pending.VictimKey = GetVictimKey(DamagedActor);
+	Pending.Sequence = PendingDamage.Num() - 1;
+	return &Pending;
+}
+
+const TArray<EHitRegion>& UBlasterDamageSubsystem::FindOrBuildHitRegionTable(const USkeletalMesh* SkeletalMesh, const ABlasterCharacter* Character)
+{
+	if (const TArray<EHitRegion>* HitRegionTable = HitRegionTables.Find(SkeletalMesh))
+	{
+		return *HitRegionTable;
+	}
+
+	// Each bone takes the region of its closest ancestor (or itself) listed in the character's region bones
+	const FReferenceSkeleton& RefSkeleton = SkeletalMesh->GetRefSkeleton();
+	const TMap<FName, EHitRegion>& HitRegionBones = Character->GetHitRegionBones();
+	TArray<EHitRegion>& HitRegionTable = HitRegionTables.Add(SkeletalMesh);
+	HitRegionTable.Init(EHitRegion::EHR_Torso, RefSkeleton.GetNum());
+	for (int32 BoneIndex = 0; BoneIndex < RefSkeleton.GetNum(); ++BoneIndex)
+	{
+		for (int32 AncestorIndex = BoneIndex; AncestorIndex != INDEX_NONE; AncestorIndex = RefSkeleton.GetParentIndex(AncestorIndex))
+		{
+			if (const EHitRegion* Region = HitRegionBones.Find(RefSkeleton.GetBoneName(AncestorIndex)))
+			{
+				HitRegionTable[BoneIndex] = *Region;
+				break;
+			}
+		}
+	}
+	return HitRegionTable;
+}
+
+void UBlasterDamageSubsystem::FlushDamage()
+{
+	if (PendingDamage.IsEmpty()) return;
+
+	// Group hits by victim, keeping the queue order within each victim
+	PendingDamage.Sort([](const FBlasterPendingDamage& A, const FBlasterPendingDamage& B)
+	{
+		return A.VictimKey != B.VictimKey ? A.VictimKey < B.VictimKey : A.Sequence < B.Sequence;
+	});
+
+	int32 First = 0;
+	for (int32 Index = 1; Index <= PendingDamage.Num(); ++Index)
+	{
+		if (Index == PendingDamage.Num() || PendingDamage[Index].VictimKey != PendingDamage[First].VictimKey)
+		{
+			ResolveVictim(First, Index);
+			First = Index;
+		}
+	}
+
+	PendingDamage.Reset();
+}
+
+void UBlasterDamageSubsystem::ResolveVictim(int32 First, int32 Last)
+{
+	// Unlike the causer, a victim destroyed earlier in the frame takes no damage
+	AActor* DamagedActor = PendingDamage[First].DamagedActor;
+	if (!IsValid(DamagedActor)) return;
+
+	const ABlasterCharacter* BlasterCharacter = Cast<ABlasterCharacter>(DamagedActor);
+	if (BlasterCharacter && BlasterCharacter->IsEliminated()) return;
+
+	// Accumulate until the victim would be eliminated, so overkill is ignored and the lethal hit is credited
+	float RemainingHealth = BlasterCharacter ? BlasterCharacter->GetHealth() : TNumericLimits<float>::Max();
+	float TotalDamage = 0.f;
+	int32 CreditedIndex = First;
+	for (int32 Index = First; Index < Last; ++Index)
+	{
+		const FBlasterPendingDamage& Pending = PendingDamage[Index];
+		TotalDamage += Pending.BaseDamage;
+		RemainingHealth -= Pending.BaseDamage;
+		CreditedIndex = Index;
+		if (RemainingHealth <= 0.f) break;
+	}
+
+	// The credited hit also decides the hit region and direction the victim reacts to
+	const FBlasterPendingDamage& Credited = PendingDamage[CreditedIndex];
+	if (Credited.bIsPointDamage)
+	{
+		UGameplayStatics::ApplyPointDamage(DamagedActor, TotalDamage, Credited.HitFromDirection, Credited.HitInfo, Credited.EventInstigator, Credited.DamageCauser, Credited.DamageTypeClass);
+	}
+	else
+	{
+		UGameplayStatics::ApplyDamage(DamagedActor, TotalDamage, Credited.EventInstigator, Credited.DamageCauser, Credited.DamageTypeClass);
+	}
+}
+
+int32 UBlasterDamageSubsystem::GetVictimKey(const AActor* DamagedActor)
+{
+	const APawn* Pawn = Cast<APawn>(DamagedActor);
+	if (Pawn && Pawn->GetPlayerState())
+	{
+		return Pawn->GetPlayerState()->GetPlayerId();
+	}
+	// Keep non-player actors apart from player ids
+	return -static_cast<int32>(DamagedActor->GetUniqueID()) - 1;
+}
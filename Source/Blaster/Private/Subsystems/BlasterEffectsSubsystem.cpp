@@ -0,0 +1,109 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterEffectsSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "NiagaraComponent.h"
+#include "NiagaraFunctionLibrary.h"
+
+static TAutoConsoleVariable<int32> CVarBlasterEffectsMaxPerSystem(
+	TEXT("blaster.Effects.MaxPerSystem"),
+	16,
+	TEXT("Maximum number of live components per Blaster Niagara system. 0: unlimited"),
+	ECVF_Scalability);
+
+static TAutoConsoleVariable<float> CVarBlasterEffectsCullDistance(
+	TEXT("blaster.Effects.CullDistance"),
+	8000.f,
+	TEXT("Blaster effects further than this from every local view are not spawned. 0: never cull"),
+	ECVF_Scalability);
+
+bool UBlasterEffectsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+UNiagaraComponent* UBlasterEffectsSubsystem::SpawnEffectAtLocation(const UObject* WorldContextObject, UNiagaraSystem* System, const FVector& Location, const FRotator& Rotation)
+{
+	UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	UBlasterEffectsSubsystem* Effects = World ? World->GetSubsystem<UBlasterEffectsSubsystem>() : nullptr;
+	if (!System || !Effects || !Effects->CanSpawnEffect(System, Location)) return nullptr;
+
+	UNiagaraComponent* EffectComponent = UNiagaraFunctionLibrary::SpawnSystemAtLocation(World, System, Location, Rotation, FVector(1.f), true, true, ENCPoolMethod::AutoRelease);
+	Effects->TrackEffect(System, EffectComponent);
+	return EffectComponent;
+}
+
+UNiagaraComponent* UBlasterEffectsSubsystem::SpawnEffectAttached(UNiagaraSystem* System, USceneComponent* AttachToComponent, const FVector& Location, const FRotator& Rotation)
+{
+	UWorld* World = AttachToComponent ? AttachToComponent->GetWorld() : nullptr;
+	UBlasterEffectsSubsystem* Effects = World ? World->GetSubsystem<UBlasterEffectsSubsystem>() : nullptr;
+	if (!System || !Effects || !Effects->CanSpawnEffect(System, Location)) return nullptr;
+
+	// Manual release so the component is not reclaimed while still attached to its owner
+	UNiagaraComponent* EffectComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(System, AttachToComponent, NAME_None, Location, Rotation, EAttachLocation::Type::KeepWorldPosition, false, true, ENCPoolMethod::ManualRelease);
+	Effects->TrackEffect(System, EffectComponent);
+	return EffectComponent;
+}
+
+void UBlasterEffectsSubsystem::ReleaseEffect(UNiagaraComponent* EffectComponent)
+{
+	if (!IsValid(EffectComponent)) return;
+
+	// Leave the trail where it is and let the pool reclaim the component once its particles die
+	EffectComponent->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
+	EffectComponent->Deactivate();
+	EffectComponent->ReleaseToPool();
+}
+
+bool UBlasterEffectsSubsystem::CanSpawnEffect(const UNiagaraSystem* System, const FVector& Location)
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr || World->GetNetMode() == NM_DedicatedServer) return false;
+
+	const float CullDistance = CVarBlasterEffectsCullDistance.GetValueOnGameThread();
+	if (CullDistance > 0.f)
+	{
+		bool bInRange = false;
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			const APlayerController* PlayerController = It->Get();
+			if (PlayerController == nullptr || !PlayerController->IsLocalController()) continue;
+
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+			if (FVector::DistSquared(ViewLocation, Location) <= FMath::Square(CullDistance))
+			{
+				bInRange = true;
+				break;
+			}
+		}
+		if (!bInRange) return false;
+	}
+
+	const int32 MaxPerSystem = CVarBlasterEffectsMaxPerSystem.GetValueOnGameThread();
+	if (MaxPerSystem > 0)
+	{
+		if (TArray<TWeakObjectPtr<UNiagaraComponent>>* Active = ActiveEffects.Find(System))
+		{
+			Active->RemoveAllSwap([](const TWeakObjectPtr<UNiagaraComponent>& EffectComponent)
+			{
+				return !EffectComponent.IsValid() || !EffectComponent->IsActive();
+			}, EAllowShrinking::No);
+			return Active->Num() < MaxPerSystem;
+		}
+	}
+	return true;
+}
+
+void UBlasterEffectsSubsystem::TrackEffect(const UNiagaraSystem* System, UNiagaraComponent* EffectComponent)
+{
+	if (EffectComponent)
+	{
+		ActiveEffects.FindOrAdd(System).AddUnique(EffectComponent);
+	}
+}
@@ -0,0 +1,269 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterEventLogSubsystem.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include <atomic>
+
+DEFINE_LOG_CATEGORY_STATIC(LogBlasterEventLog, Log, All);
+
+static TAutoConsoleVariable<int32> CVarBlasterEventLog(
+	TEXT("blaster.EventLog"),
+	0,
+	TEXT("Write server gameplay events to a binary log in Saved/EventLogs. 0: off, 1: on"),
+	ECVF_Default);
+
+/*
+*	Single producer, single consumer ring of events. The game thread pushes, the writer thread pops
+*/
+class FBlasterEventRing
+{
+public:
+	static constexpr uint32 Capacity = 1 << 14;
+
+	bool Push(const FBlasterGameplayEvent& Event)
+	{
+		const uint32 Head = HeadIndex.load(std::memory_order_relaxed);
+		if (Head - TailIndex.load(std::memory_order_acquire) >= Capacity) return false;
+
+		Events[Head & (Capacity - 1)] = Event;
+		HeadIndex.store(Head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool Pop(FBlasterGameplayEvent& OutEvent)
+	{
+		const uint32 Tail = TailIndex.load(std::memory_order_relaxed);
+		if (Tail == HeadIndex.load(std::memory_order_acquire)) return false;
+
+		OutEvent = Events[Tail & (Capacity - 1)];
+		TailIndex.store(Tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	uint32 Num() const
+	{
+		return HeadIndex.load(std::memory_order_acquire) - TailIndex.load(std::memory_order_acquire);
+	}
+
+private:
+	FBlasterGameplayEvent Events[Capacity];
+
+	// Kept on separate cache lines so the two threads don't contend
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> HeadIndex{ 0 };
+	alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint32> TailIndex{ 0 };
+};
+
+/*
+*	Background thread draining the ring into the log file
+*/
+class FBlasterEventLogWriter : public FRunnable
+{
+public:
+	FBlasterEventLogWriter(const FString& InFilename, const FString& InMapName)
+		: Filename(InFilename)
+		, MapName(InMapName)
+	{
+		// The file is opened by the writer thread, so the game thread never touches the disk
+		WakeEvent = FPlatformProcess::GetSynchEventFromPool();
+		Thread.Reset(FRunnableThread::Create(this, TEXT("BlasterEventLogWriter"), 0, TPri_BelowNormal));
+	}
+
+	virtual ~FBlasterEventLogWriter() override
+	{
+		if (Thread)
+		{
+			bStopping = true;
+			WakeEvent->Trigger();
+			Thread->WaitForCompletion();
+			Thread.Reset();
+		}
+		if (WakeEvent)
+		{
+			FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+		}
+
+		if (!bOpenFailed)
+		{
+			const uint64 NumDropped = DroppedEvents.load();
+			UE_LOG(LogBlasterEventLog, Log, TEXT("Event log %s closed with %llu events%s"), *Filename, NumWritten,
+				NumDropped > 0 ? *FString::Printf(TEXT(", %llu dropped because the ring was full"), NumDropped) : TEXT(""));
+		}
+	}
+
+	bool IsValid() const { return Thread.IsValid() && !bOpenFailed; }
+
+	void Push(const FBlasterGameplayEvent& Event)
+	{
+		if (!Ring.Push(Event))
+		{
+			DroppedEvents.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		// Wake the writer early if the ring is filling up faster than it drains
+		if (Ring.Num() == FBlasterEventRing::Capacity / 2)
+		{
+			WakeEvent->Trigger();
+		}
+	}
+
+	//~ Begin FRunnable interface
+	virtual uint32 Run() override
+	{
+		if (!Open())
+		{
+			bOpenFailed = true;
+			return 0;
+		}
+
+		TArray<uint8> Batch;
+		while (!bStopping)
+		{
+			WakeEvent->Wait(FlushIntervalMs);
+			Flush(Batch);
+		}
+		Flush(Batch);
+		FileHandle.Reset();
+		return 0;
+	}
+	//~ End FRunnable interface
+
+private:
+	static constexpr uint32 FlushIntervalMs = 250;
+
+	bool Open()
+	{
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Filename));
+		FileHandle.Reset(PlatformFile.OpenWrite(*Filename));
+		if (!FileHandle)
+		{
+			UE_LOG(LogBlasterEventLog, Error, TEXT("Could not open %s"), *Filename);
+			return false;
+		}
+
+		FBlasterGameplayEventLogHeader Header;
+		Header.StartTicks = FDateTime::UtcNow().GetTicks();
+		Header.MapName = MapName;
+		TArray<uint8> HeaderBytes;
+		FMemoryWriter HeaderWriter(HeaderBytes);
+		HeaderWriter << Header;
+		FileHandle->Write(HeaderBytes.GetData(), HeaderBytes.Num());
+		return true;
+	}
+
+	void Flush(TArray<uint8>& Batch)
+	{
+		Batch.Reset();
+		FMemoryWriter BatchWriter(Batch);
+		FBlasterGameplayEvent Event;
+		while (Ring.Pop(Event))
+		{
+			BatchWriter << Event;
+			++NumWritten;
+		}
+		if (Batch.Num() > 0)
+		{
+			FileHandle->Write(Batch.GetData(), Batch.Num());
+			FileHandle->Flush();
+		}
+	}
+
+	FString Filename;
+	FString MapName;
+	TUniquePtr<IFileHandle> FileHandle;
+	TUniquePtr<FRunnableThread> Thread;
+	FEvent* WakeEvent = nullptr;
+	std::atomic<bool> bStopping{ false };
+	std::atomic<bool> bOpenFailed{ false };
+	std::atomic<uint64> DroppedEvents{ 0 };
+	uint64 NumWritten = 0;
+	FBlasterEventRing Ring;
+};
+
+void UBlasterEventLogSubsystem::Deinitialize()
+{
+	// Joins the writer thread after it has drained the ring
+	Writer.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UBlasterEventLogSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBlasterEventLogSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (CVarBlasterEventLog.GetValueOnGameThread() == 0 || InWorld.GetNetMode() == NM_Client) return;
+
+	// Forked servers and PIE instances start within the same second, so each gets its own file
+	const FString MapName = InWorld.GetMapName();
+	FString InstanceName = FString::Printf(TEXT("%s_%s_%u"), *MapName, *FDateTime::Now().ToString(), FPlatformProcess::GetCurrentProcessId());
+	const FWorldContext* WorldContext = GEngine ? GEngine->GetWorldContextFromWorld(&InWorld) : nullptr;
+	if (WorldContext && WorldContext->PIEInstance != INDEX_NONE)
+	{
+		InstanceName += FString::Printf(TEXT("_PIE%d"), WorldContext->PIEInstance);
+	}
+	const FString Filename = FPaths::ProjectSavedDir() / TEXT("EventLogs") / FString::Printf(TEXT("Events_%s.blev"), *InstanceName);
+	Writer = MakeShared<FBlasterEventLogWriter>(Filename, MapName);
+}
+
+void UBlasterEventLogSubsystem::Record(const UObject* WorldContextObject, EBlasterGameplayEvent Type, const AActor* PlayerActor, const AActor* OtherPlayerActor, float Value, const FVector& Location, uint8 Detail)
+{
+	if (CVarBlasterEventLog.GetValueOnGameThread() == 0) return;
+
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	if (World == nullptr || World->GetNetMode() == NM_Client) return;
+
+	if (UBlasterEventLogSubsystem* EventLog = World->GetSubsystem<UBlasterEventLogSubsystem>())
+	{
+		FBlasterGameplayEvent Event;
+		Event.Frame = static_cast<uint32>(GFrameCounter);
+		Event.Time = World->GetTimeSeconds();
+		Event.Type = Type;
+		Event.Detail = Detail;
+		Event.PlayerId = GetPlayerId(PlayerActor);
+		Event.OtherPlayerId = GetPlayerId(OtherPlayerActor);
+		Event.Value = Value;
+		Event.Location = FVector3f(Location);
+		EventLog->Push(Event);
+	}
+}
+
+int32 UBlasterEventLogSubsystem::GetPlayerId(const AActor* PlayerActor)
+{
+	const APlayerState* PlayerState = Cast<APlayerState>(PlayerActor);
+	if (const APawn* Pawn = Cast<APawn>(PlayerActor))
+	{
+		PlayerState = Pawn->GetPlayerState();
+	}
+	else if (const AController* Controller = Cast<AController>(PlayerActor))
+	{
+		PlayerState = Controller->PlayerState;
+	}
+	return PlayerState ? PlayerState->GetPlayerId() : INDEX_NONE;
+}
+
+void UBlasterEventLogSubsystem::Push(const FBlasterGameplayEvent& Event)
+{
+	if (Writer.IsValid() && Writer->IsValid())
+	{
+		Writer->Push(Event);
+	}
+}
@@ -0,0 +1,460 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterNetStatsSubsystem.h"
+
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/PackageMapClient.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/Stack.h"
+
+static TAutoConsoleVariable<int32> CVarBlasterNetStats(
+	TEXT("blaster.NetStats"),
+	0,
+	TEXT("Collect bytes and calls per replicated property, RPC and connection. 0: off, 1: on"),
+	ECVF_Default);
+
+static FAutoConsoleCommandWithWorldAndArgs BlasterNetStatsTopCommand(
+	TEXT("blaster.NetStats.Top"),
+	TEXT("Print the Blaster net stats with the most bytes. Usage: blaster.NetStats.Top [Count]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (const UBlasterNetStatsSubsystem* NetStats = World ? World->GetSubsystem<UBlasterNetStatsSubsystem>() : nullptr)
+		{
+			NetStats->LogTopEntries(Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 10);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs BlasterNetStatsResetCommand(
+	TEXT("blaster.NetStats.Reset"),
+	TEXT("Clear the collected Blaster net stats"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UBlasterNetStatsSubsystem* NetStats = World ? World->GetSubsystem<UBlasterNetStatsSubsystem>() : nullptr)
+		{
+			NetStats->Reset();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs BlasterNetStatsDumpCommand(
+	TEXT("blaster.NetStats.Dump"),
+	TEXT("Write the collected Blaster net stats to a CSV file. Usage: blaster.NetStats.Dump [Filename]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (const UBlasterNetStatsSubsystem* NetStats = World ? World->GetSubsystem<UBlasterNetStatsSubsystem>() : nullptr)
+		{
+			const FString Filename = Args.Num() > 0 ? Args[0] : FPaths::ProfilingDir() / TEXT("NetStats") / FString::Printf(TEXT("NetStats_%s.csv"), *FDateTime::Now().ToString());
+			NetStats->WriteCSV(Filename);
+		}
+	}));
+
+void UBlasterNetStatsSubsystem::Deinitialize()
+{
+	BindNetDriver(false);
+
+	// Export a per-match summary. Clients have one too, since they count the server RPCs they send
+	const UWorld* World = GetWorld();
+	if (World && Stats.Num() > 0)
+	{
+		FString InstanceName = FString::Printf(TEXT("%s_%s_%u"), *World->GetMapName(), *FDateTime::Now().ToString(), FPlatformProcess::GetCurrentProcessId());
+		const FWorldContext* WorldContext = GEngine ? GEngine->GetWorldContextFromWorld(World) : nullptr;
+		if (WorldContext && WorldContext->PIEInstance != INDEX_NONE)
+		{
+			InstanceName += FString::Printf(TEXT("_PIE%d"), WorldContext->PIEInstance);
+		}
+		WriteCSV(FPaths::ProfilingDir() / TEXT("NetStats") / FString::Printf(TEXT("NetStats_%s.csv"), *InstanceName));
+	}
+
+	Super::Deinitialize();
+}
+
+bool UBlasterNetStatsSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBlasterNetStatsSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (!IsEnabled())
+	{
+		// Start over when collection is turned back on, so the gap isn't counted as one frame of traffic
+		bWatching = false;
+		ShadowValues.Reset();
+		WireSamples.Reset();
+		BindNetDriver(false);
+		return;
+	}
+
+	BindNetDriver(true);
+	WatchReplicatedProperties();
+	SampleWireTraffic();
+}
+
+TStatId UBlasterNetStatsSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBlasterNetStatsSubsystem, STATGROUP_Tickables);
+}
+
+bool UBlasterNetStatsSubsystem::IsEnabled()
+{
+	return CVarBlasterNetStats.GetValueOnGameThread() != 0;
+}
+
+void UBlasterNetStatsSubsystem::Record(FName Name, EBlasterNetStatKind Kind, const UNetConnection* Connection, int32 NumBits, int32 NumCalls)
+{
+	FNetStat& Stat = Stats.FindOrAdd(Name);
+	Stat.Kind = Kind;
+	Stat.Total.Calls += NumCalls;
+	Stat.Total.Bits += NumBits;
+
+	FNetStatCounter& ConnectionCounter = Stat.PerConnection.FindOrAdd(GetConnectionName(Connection));
+	ConnectionCounter.Calls += NumCalls;
+	ConnectionCounter.Bits += NumBits;
+}
+
+void UBlasterNetStatsSubsystem::RecordForCondition(const AActor* Actor, FName Name, EBlasterNetStatKind Kind, int32 NumBits, ELifetimeCondition Condition)
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (!NetDriver) return;
+
+	const UNetConnection* OwnerConnection = Actor->GetNetConnection();
+	const bool bOwnerIsAutonomous = Actor->GetRemoteRole() == ROLE_AutonomousProxy;
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (!Connection || !Connection->PlayerController || !Connection->ViewTarget) continue;
+
+		const bool bIsOwner = Connection == OwnerConnection;
+		bool bSent = true;
+		switch (Condition)
+		{
+		case COND_InitialOnly:
+		case COND_ReplayOnly:
+		case COND_Never:
+			bSent = false;
+			break;
+		case COND_OwnerOnly:
+		case COND_AutonomousOnly:
+		case COND_InitialOrOwner:
+		case COND_ReplayOrOwner:
+			bSent = bIsOwner;
+			break;
+		case COND_SkipOwner:
+			bSent = !bIsOwner;
+			break;
+		case COND_SimulatedOnly:
+		case COND_SimulatedOrPhysics:
+		case COND_SimulatedOnlyNoReplay:
+		case COND_SimulatedOrPhysicsNoReplay:
+			// Only the owner of a possessed pawn sees it as an autonomous proxy
+			bSent = !(bIsOwner && bOwnerIsAutonomous);
+			break;
+		default:
+			break;
+		}
+
+		if (bSent && Actor->IsNetRelevantFor(Connection->PlayerController, Connection->ViewTarget, Connection->ViewTarget->GetActorLocation()))
+		{
+			Record(Name, Kind, Connection, NumBits);
+		}
+	}
+}
+
+void UBlasterNetStatsSubsystem::WatchReplicatedProperties()
+{
+	const UWorld* World = GetWorld();
+	const UNetDriver* NetDriver = World->GetNetDriver();
+	if (World->GetNetMode() == NM_Client || !NetDriver) return;
+
+	// Objects that are gone drop out of the shadow values by not being moved back
+	TMap<TObjectKey<UObject>, TArray<FShadowValue>> PreviousValues = MoveTemp(ShadowValues);
+	ShadowValues.Reset();
+
+	const FNetGUIDCache* GuidCache = NetDriver->GuidCache.Get();
+	for (TActorIterator<AActor> It(GetWorld()); It; ++It)
+	{
+		const AActor* Actor = *It;
+		if (!Actor->GetIsReplicated() || Actor->IsActorBeingDestroyed()) continue;
+
+		const bool bIsNewActor = !PreviousValues.Contains(Actor);
+		int32 StateBits = WatchObject(Actor, Actor, GuidCache, PreviousValues);
+		for (const UActorComponent* Component : Actor->GetComponents())
+		{
+			if (Component && Component->GetIsReplicated())
+			{
+				StateBits += WatchObject(Actor, Component, GuidCache, PreviousValues);
+			}
+		}
+
+		// A new actor goes out with its whole state. Actors that were already there when collection started aren't spawns
+		if (bIsNewActor && bWatching)
+		{
+			RecordForCondition(Actor, Actor->GetClass()->GetFName(), EBlasterNetStatKind::EBNSK_Spawn, StateBits, COND_None);
+		}
+	}
+	bWatching = true;
+}
+
+int32 UBlasterNetStatsSubsystem::WatchObject(const AActor* Actor, const UObject* Object, const FNetGUIDCache* GuidCache, TMap<TObjectKey<UObject>, TArray<FShadowValue>>& PreviousValues)
+{
+	const TArray<FWatchedProperty>& WatchedProperties = GetWatchedProperties(Object);
+
+	TArray<FShadowValue> Values;
+	const bool bHasPreviousValues = PreviousValues.RemoveAndCopyValue(Object, Values);
+	Values.SetNum(WatchedProperties.Num());
+
+	int32 StateBits = 0;
+	for (int32 Index = 0; Index < WatchedProperties.Num(); ++Index)
+	{
+		const FWatchedProperty& Watched = WatchedProperties[Index];
+
+		FNetBitWriter Writer(nullptr, 0);
+		SerializeValue(Writer, Watched.Property, Watched.Property->ContainerPtrToValuePtr<void>(Object, Watched.ArrayIndex), GuidCache);
+		StateBits += static_cast<int32>(Writer.GetNumBits());
+
+		FShadowValue& Value = Values[Index];
+		const bool bChanged = Value.NumBits != Writer.GetNumBits() || FMemory::Memcmp(Value.Data.GetData(), Writer.GetData(), Writer.GetNumBytes()) != 0;
+		if (!bChanged) continue;
+
+		// The engine also sends at most one value per net update, however often the property was set in between
+		if (bHasPreviousValues)
+		{
+			RecordForCondition(Actor, Watched.Property->GetFName(), EBlasterNetStatKind::EBNSK_Property, static_cast<int32>(Writer.GetNumBits()), Watched.Condition);
+		}
+		Value.Data = TArray<uint8>(Writer.GetData(), Writer.GetNumBytes());
+		Value.NumBits = Writer.GetNumBits();
+	}
+
+	ShadowValues.Add(Object, MoveTemp(Values));
+	return StateBits;
+}
+
+const TArray<UBlasterNetStatsSubsystem::FWatchedProperty>& UBlasterNetStatsSubsystem::GetWatchedProperties(const UObject* Object)
+{
+	UClass* Class = Object->GetClass();
+	if (const TArray<FWatchedProperty>* WatchedProperties = WatchedPropertiesByClass.Find(Class))
+	{
+		return *WatchedProperties;
+	}
+
+	// The same list and conditions the engine builds its replication layout from
+	Class->SetUpRuntimeReplicationData();
+	TArray<FLifetimeProperty> LifetimeProperties;
+	Object->GetLifetimeReplicatedProps(LifetimeProperties);
+
+	TArray<FWatchedProperty>& WatchedProperties = WatchedPropertiesByClass.Add(Class);
+	for (const FLifetimeProperty& LifetimeProperty : LifetimeProperties)
+	{
+		if (!Class->ClassReps.IsValidIndex(LifetimeProperty.RepIndex) || LifetimeProperty.Condition == COND_Never) continue;
+
+		const FRepRecord& RepRecord = Class->ClassReps[LifetimeProperty.RepIndex];
+		WatchedProperties.Add({ RepRecord.Property, RepRecord.Index, LifetimeProperty.Condition });
+	}
+	return WatchedProperties;
+}
+
+void UBlasterNetStatsSubsystem::SerializeValue(FNetBitWriter& Writer, const FProperty* Property, const void* Value, const FNetGUIDCache* GuidCache)
+{
+	if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(Property))
+	{
+		// References go out as the NetGUID the package map assigned. Looking it up here keeps the package map's export state untouched
+		const UObject* Object = ObjectProperty->GetObjectPropertyValue(Value);
+		FNetworkGUID NetGUID = Object && GuidCache ? GuidCache->GetNetGUID(Object) : FNetworkGUID();
+		Writer << NetGUID;
+	}
+	else if (const FArrayProperty* ArrayProperty = CastField<FArrayProperty>(Property))
+	{
+		FScriptArrayHelper ArrayHelper(ArrayProperty, Value);
+		uint16 NumElements = static_cast<uint16>(ArrayHelper.Num());
+		Writer << NumElements;
+		for (int32 Index = 0; Index < ArrayHelper.Num(); ++Index)
+		{
+			SerializeValue(Writer, ArrayProperty->Inner, ArrayHelper.GetRawPtr(Index), GuidCache);
+		}
+	}
+	else if (const FStructProperty* StructProperty = CastField<FStructProperty>(Property); StructProperty && !(StructProperty->Struct->StructFlags & STRUCT_NetSerializeNative))
+	{
+		// Structs without a NetSerialize go out member by member. Fast arrays are delta serialized, so this is their full size
+		for (TFieldIterator<FProperty> It(StructProperty->Struct); It; ++It)
+		{
+			if (It->HasAnyPropertyFlags(CPF_RepSkip)) continue;
+
+			for (int32 ArrayIndex = 0; ArrayIndex < It->ArrayDim; ++ArrayIndex)
+			{
+				SerializeValue(Writer, *It, It->ContainerPtrToValuePtr<void>(Value, ArrayIndex), GuidCache);
+			}
+		}
+	}
+	else if (!Property->IsA<FInterfaceProperty>() && !Property->IsA<FDelegateProperty>() && !Property->IsA<FMulticastDelegateProperty>())
+	{
+		Property->NetSerializeItem(Writer, nullptr, const_cast<void*>(Value));
+	}
+}
+
+void UBlasterNetStatsSubsystem::SampleWireTraffic()
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (!NetDriver) return;
+
+	TArray<const UNetConnection*> Connections;
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		Connections.Add(Connection);
+	}
+	if (NetDriver->ServerConnection)
+	{
+		Connections.Add(NetDriver->ServerConnection);
+	}
+
+	for (const UNetConnection* Connection : Connections)
+	{
+		if (!Connection) continue;
+
+		const FWireSample Sample{ Connection->InTotalBytes, Connection->OutTotalBytes, Connection->InTotalPackets, Connection->OutTotalPackets };
+		if (const FWireSample* PreviousSample = WireSamples.Find(Connection))
+		{
+			Record(TEXT("WireOut"), EBlasterNetStatKind::EBNSK_Wire, Connection, static_cast<int32>((Sample.OutBytes - PreviousSample->OutBytes) * 8), static_cast<int32>(Sample.OutPackets - PreviousSample->OutPackets));
+			Record(TEXT("WireIn"), EBlasterNetStatKind::EBNSK_Wire, Connection, static_cast<int32>((Sample.InBytes - PreviousSample->InBytes) * 8), static_cast<int32>(Sample.InPackets - PreviousSample->InPackets));
+		}
+		WireSamples.Add(Connection, Sample);
+	}
+}
+
+void UBlasterNetStatsSubsystem::BindNetDriver(bool bBind)
+{
+	UNetDriver* NetDriver = bBind ? GetWorld()->GetNetDriver() : nullptr;
+	if (BoundNetDriver.Get() == NetDriver) return;
+
+	if (UNetDriver* PreviousNetDriver = BoundNetDriver.Get(); PreviousNetDriver && PreviousNetDriver->SendRPCDel.IsBoundToObject(this))
+	{
+		PreviousNetDriver->SendRPCDel.Unbind();
+	}
+	BoundNetDriver.Reset();
+
+	// The send hook holds a single delegate, so leave one that something else installed alone
+	if (NetDriver && !NetDriver->SendRPCDel.IsBound())
+	{
+		NetDriver->SendRPCDel.BindUObject(this, &UBlasterNetStatsSubsystem::OnSendRPC);
+		BoundNetDriver = NetDriver;
+	}
+}
+
+void UBlasterNetStatsSubsystem::OnSendRPC(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject, bool& bBlockSendRPC)
+{
+	const UNetDriver* NetDriver = BoundNetDriver.Get();
+	if (!IsEnabled() || !Actor || !Function || !NetDriver) return;
+
+	const int32 NumBits = GetParameterBits(Function, Parameters, OutParms, NetDriver->GuidCache.Get());
+	if (Function->HasAnyFunctionFlags(FUNC_NetMulticast))
+	{
+		RecordForCondition(Actor, Function->GetFName(), EBlasterNetStatKind::EBNSK_RPC, NumBits, COND_None);
+	}
+	else if (Function->HasAnyFunctionFlags(FUNC_NetServer))
+	{
+		if (NetDriver->ServerConnection)
+		{
+			Record(Function->GetFName(), EBlasterNetStatKind::EBNSK_RPC, NetDriver->ServerConnection, NumBits);
+		}
+	}
+	else if (const UNetConnection* Connection = Actor->GetNetConnection())
+	{
+		Record(Function->GetFName(), EBlasterNetStatKind::EBNSK_RPC, Connection, NumBits);
+	}
+}
+
+int32 UBlasterNetStatsSubsystem::GetParameterBits(const UFunction* Function, void* Parameters, FOutParmRec* OutParms, const FNetGUIDCache* GuidCache)
+{
+	// The same parameters the engine writes into the RPC bunch
+	FNetBitWriter Writer(nullptr, 0);
+	for (TFieldIterator<FProperty> It(Function); It && (It->PropertyFlags & (CPF_Parm | CPF_ReturnParm)) == CPF_Parm; ++It)
+	{
+		// Reference parameters of a call from script live in the caller's frame rather than the parameter block
+		const void* Container = Parameters;
+		if (It->HasAnyPropertyFlags(CPF_OutParm))
+		{
+			for (const FOutParmRec* OutParm = OutParms; OutParm; OutParm = OutParm->NextOutParm)
+			{
+				if (OutParm->Property == *It)
+				{
+					Container = OutParm->PropAddr - It->GetOffset_ForUFunction();
+					break;
+				}
+			}
+		}
+
+		for (int32 ArrayIndex = 0; ArrayIndex < It->ArrayDim; ++ArrayIndex)
+		{
+			SerializeValue(Writer, *It, It->ContainerPtrToValuePtr<void>(Container, ArrayIndex), GuidCache);
+		}
+	}
+	return static_cast<int32>(Writer.GetNumBits());
+}
+
+FString UBlasterNetStatsSubsystem::GetConnectionName(const UNetConnection* Connection)
+{
+	if (Connection->PlayerController && Connection->PlayerController->PlayerState)
+	{
+		return Connection->PlayerController->PlayerState->GetPlayerName();
+	}
+	return Connection->LowLevelGetRemoteAddress(true);
+}
+
+void UBlasterNetStatsSubsystem::LogTopEntries(int32 Count) const
+{
+	TArray<FName> Names;
+	Stats.GenerateKeyArray(Names);
+	Names.Sort([this](const FName& A, const FName& B)
+	{
+		return Stats[A].Total.Bits > Stats[B].Total.Bits;
+	});
+
+	UE_LOG(LogNet, Display, TEXT("Blaster net stats (top %d of %d)"), Count, Names.Num());
+	for (int32 Index = 0; Index < FMath::Min(Count, Names.Num()); ++Index)
+	{
+		const FNetStat& Stat = Stats[Names[Index]];
+		UE_LOG(LogNet, Display, TEXT("  %-24s %-8s %8lld calls %10lld bytes"),
+			*Names[Index].ToString(),
+			*UEnum::GetDisplayValueAsText(Stat.Kind).ToString(),
+			Stat.Total.Calls,
+			(Stat.Total.Bits + 7) / 8);
+	}
+}
+
+bool UBlasterNetStatsSubsystem::WriteCSV(const FString& Filename) const
+{
+	FString CSV(TEXT("Kind,Name,Connection,Calls,Bytes\n"));
+	for (const TPair<FName, FNetStat>& Entry : Stats)
+	{
+		const FString Kind = UEnum::GetDisplayValueAsText(Entry.Value.Kind).ToString();
+		for (const TPair<FString, FNetStatCounter>& ConnectionEntry : Entry.Value.PerConnection)
+		{
+			CSV += FString::Printf(TEXT("%s,%s,%s,%lld,%lld\n"),
+				*Kind,
+				*Entry.Key.ToString(),
+				*ConnectionEntry.Key,
+				ConnectionEntry.Value.Calls,
+				(ConnectionEntry.Value.Bits + 7) / 8);
+		}
+	}
+
+	const bool bSaved = FFileHelper::SaveStringToFile(CSV, *Filename);
+	UE_LOG(LogNet, Display, TEXT("Blaster net stats %s %s"), bSaved ? TEXT("written to") : TEXT("could not be written to"), *Filename);
+	return bSaved;
+}
+
+void UBlasterNetStatsSubsystem::Reset()
+{
+	Stats.Reset();
+	ShadowValues.Reset();
+	WireSamples.Reset();
+	bWatching = false;
+}
@@ -0,0 +1,157 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterPickupSubsystem.h"
+
+#include "Character/BlasterCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Weapon/Weapon.h"
+
+static TAutoConsoleVariable<float> CVarBlasterPickupUpdateRate(
+	TEXT("blaster.Pickup.UpdateRate"),
+	10.f,
+	TEXT("How many times per second the server looks for weapons characters can pick up"),
+	ECVF_Default);
+
+void UBlasterPickupSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const UWorld* World = GetWorld();
+	if (!World || World->GetNetMode() == NM_Client) return;
+
+	TimeSinceUpdate += DeltaTime;
+	const float UpdateInterval = 1.f / FMath::Max(CVarBlasterPickupUpdateRate.GetValueOnGameThread(), 1.f);
+	if (TimeSinceUpdate >= UpdateInterval)
+	{
+		TimeSinceUpdate = FMath::Fmod(TimeSinceUpdate, UpdateInterval);
+		UpdatePickups();
+	}
+}
+
+TStatId UBlasterPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UBlasterPickupSubsystem, STATGROUP_Tickables);
+}
+
+bool UBlasterPickupSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UBlasterPickupSubsystem::RegisterPickup(AWeapon* Weapon)
+{
+	const UWorld* World = Weapon ? Weapon->GetWorld() : nullptr;
+	if (UBlasterPickupSubsystem* PickupSubsystem = World ? World->GetSubsystem<UBlasterPickupSubsystem>() : nullptr)
+	{
+		PickupSubsystem->Pickups.AddUnique(Weapon);
+	}
+}
+
+void UBlasterPickupSubsystem::UnregisterPickup(AWeapon* Weapon)
+{
+	const UWorld* World = Weapon ? Weapon->GetWorld() : nullptr;
+	if (UBlasterPickupSubsystem* PickupSubsystem = World ? World->GetSubsystem<UBlasterPickupSubsystem>() : nullptr)
+	{
+		// The hash holds indices, so it is rebuilt before the next query
+		PickupSubsystem->Pickups.RemoveSingleSwap(Weapon, EAllowShrinking::No);
+		PickupSubsystem->Cells.Reset();
+
+		// Don't wait for the next update to stop offering the weapon to other characters
+		for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+		{
+			const APlayerController* PlayerController = It->Get();
+			ABlasterCharacter* BlasterCharacter = PlayerController ? Cast<ABlasterCharacter>(PlayerController->GetPawn()) : nullptr;
+			if (BlasterCharacter && BlasterCharacter->GetOverlappingWeapon() == Weapon)
+			{
+				BlasterCharacter->SetOverlappingWeapon(nullptr);
+			}
+		}
+	}
+}
+
+void UBlasterPickupSubsystem::UpdatePickups()
+{
+	RebuildHash();
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		ABlasterCharacter* BlasterCharacter = PlayerController ? Cast<ABlasterCharacter>(PlayerController->GetPawn()) : nullptr;
+		if (!BlasterCharacter) continue;
+
+		AWeapon* NearestPickup = BlasterCharacter->IsEliminated() ? nullptr : FindNearestPickup(BlasterCharacter);
+		if (BlasterCharacter->GetOverlappingWeapon() != NearestPickup)
+		{
+			BlasterCharacter->SetOverlappingWeapon(NearestPickup);
+		}
+	}
+}
+
+void UBlasterPickupSubsystem::RebuildHash()
+{
+	Pickups.RemoveAllSwap([](const TWeakObjectPtr<AWeapon>& Weapon) { return !Weapon.IsValid(); }, EAllowShrinking::No);
+
+	LargestPickupRadius = 0.f;
+	for (const TWeakObjectPtr<AWeapon>& Weapon : Pickups)
+	{
+		LargestPickupRadius = FMath::Max(LargestPickupRadius, Weapon->GetPickupRadius());
+	}
+	CellSize = FMath::Max(2.f * LargestPickupRadius, 1.f);
+
+	Cells.Reset();
+	for (int32 Index = 0; Index < Pickups.Num(); ++Index)
+	{
+		Cells.FindOrAdd(GetCell(Pickups[Index]->GetActorLocation())).Add(Index);
+	}
+}
+
+AWeapon* UBlasterPickupSubsystem::FindNearestPickup(const ABlasterCharacter* Character) const
+{
+	if (Cells.IsEmpty()) return nullptr;
+
+	// Match the old sphere against capsule overlap by reaching out by the capsule radius
+	const FVector Location = Character->GetActorLocation();
+	const float Reach = Character->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	const FIntVector MinCell = GetCell(Location - FVector(LargestPickupRadius + Reach));
+	const FIntVector MaxCell = GetCell(Location + FVector(LargestPickupRadius + Reach));
+
+	AWeapon* NearestPickup = nullptr;
+	double NearestDistanceSquared = TNumericLimits<double>::Max();
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<int32>* Cell = Cells.Find(FIntVector(X, Y, Z));
+				if (!Cell) continue;
+
+				for (const int32 Index : *Cell)
+				{
+					AWeapon* Weapon = Pickups[Index].Get();
+					if (!Weapon) continue;
+
+					const double DistanceSquared = FVector::DistSquared(Location, Weapon->GetActorLocation());
+					if (DistanceSquared < NearestDistanceSquared && DistanceSquared <= FMath::Square(Weapon->GetPickupRadius() + Reach))
+					{
+						NearestPickup = Weapon;
+						NearestDistanceSquared = DistanceSquared;
+					}
+				}
+			}
+		}
+	}
+	return NearestPickup;
+}
+
+FIntVector UBlasterPickupSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize));
+}
@@ -0,0 +1,72 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterPreloadSubsystem.h"
+
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "UObject/Package.h"
+
+void UBlasterPreloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UBlasterPreloadSubsystem::OnPostLoadMap);
+}
+
+void UBlasterPreloadSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	ReleasePreloadedAssets();
+
+	Super::Deinitialize();
+}
+
+void UBlasterPreloadSubsystem::PreloadAssets(const TArray<FSoftObjectPath>& Assets, const FString& InDestinationMapPackage, FSimpleDelegate OnComplete)
+{
+	DestinationMapPackage = InDestinationMapPackage;
+
+	TSharedPtr<FStreamableHandle> Handle = Assets.IsEmpty() ? nullptr : UAssetManager::GetStreamableManager().RequestAsyncLoad(Assets, OnComplete, FStreamableManager::AsyncLoadHighPriority);
+	if (Handle.IsValid())
+	{
+		PreloadHandles.Add(Handle);
+	}
+	else
+	{
+		// Nothing to load, or everything was already in memory
+		OnComplete.ExecuteIfBound();
+	}
+}
+
+bool UBlasterPreloadSubsystem::IsPreloading() const
+{
+	return PreloadHandles.ContainsByPredicate([](const TSharedPtr<FStreamableHandle>& Handle)
+	{
+		return Handle.IsValid() && Handle->IsLoadingInProgress();
+	});
+}
+
+void UBlasterPreloadSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (PreloadHandles.IsEmpty() || LoadedWorld == nullptr) return;
+
+	// The destination map now holds hard references to everything it needs
+	const FString LoadedPackage = UWorld::RemovePIEPrefix(LoadedWorld->GetOutermost()->GetName());
+	if (LoadedPackage == DestinationMapPackage)
+	{
+		ReleasePreloadedAssets();
+	}
+}
+
+void UBlasterPreloadSubsystem::ReleasePreloadedAssets()
+{
+	for (const TSharedPtr<FStreamableHandle>& Handle : PreloadHandles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->ReleaseHandle();
+		}
+	}
+	PreloadHandles.Reset();
+}
@@ -0,0 +1,259 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterReplaySubsystem.h"
+
+#include "CoreGlobals.h"
+#include "Engine/DemoNetDriver.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBlasterReplay, Log, All);
+
+static TAutoConsoleVariable<int32> CVarBlasterReplayAutoRecord(
+	TEXT("blaster.Replay.AutoRecord"),
+	0,
+	TEXT("Record a replay of every match on the server. 0: off, 1: on"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBlasterReplayProfileDeltaTime(
+	TEXT("blaster.Replay.ProfileDeltaTime"),
+	1.f / 60.f,
+	TEXT("Fixed timestep in seconds used when profiling a replay"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBlasterReplaySpikeMs(
+	TEXT("blaster.Replay.SpikeMs"),
+	33.f,
+	TEXT("Frames slower than this while profiling a replay are bookmarked in Insights"),
+	ECVF_Default);
+
+static UBlasterReplaySubsystem* GetReplaySubsystem(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UBlasterReplaySubsystem>() : nullptr;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs BlasterReplayRecordCommand(
+	TEXT("blaster.Replay.Record"),
+	TEXT("Start recording a replay. Usage: blaster.Replay.Record [Name]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UBlasterReplaySubsystem* Replay = GetReplaySubsystem(World))
+		{
+			Replay->StartRecording(Args.Num() > 0 ? Args[0] : FString::Printf(TEXT("Blaster_%s"), *FDateTime::Now().ToString()));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs BlasterReplayStopCommand(
+	TEXT("blaster.Replay.Stop"),
+	TEXT("Stop recording the current replay"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UBlasterReplaySubsystem* Replay = GetReplaySubsystem(World))
+		{
+			Replay->StopRecording();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs BlasterReplayPlayCommand(
+	TEXT("blaster.Replay.Play"),
+	TEXT("Play a replay. Usage: blaster.Replay.Play Name"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		UBlasterReplaySubsystem* Replay = GetReplaySubsystem(World);
+		if (Replay && Args.Num() > 0)
+		{
+			Replay->PlayReplay(Args[0], false);
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs BlasterReplayProfileCommand(
+	TEXT("blaster.Replay.Profile"),
+	TEXT("Play a replay at a fixed timestep as fast as possible and write its frame timings to a CSV. Usage: blaster.Replay.Profile Name"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic([](const TArray<FString>& Args, UWorld* World)
+	{
+		UBlasterReplaySubsystem* Replay = GetReplaySubsystem(World);
+		if (Replay && Args.Num() > 0)
+		{
+			Replay->PlayReplay(Args[0], true);
+		}
+	}));
+
+void UBlasterReplaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FNetworkReplayDelegates::OnReplayPlaybackComplete.AddUObject(this, &UBlasterReplaySubsystem::OnReplayPlaybackComplete);
+
+	// Headless profiling starts as soon as the engine has finished loading the startup map
+	FString ReplayName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("ReplayProfile="), ReplayName))
+	{
+		FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateWeakLambda(this, [this, ReplayName](float DeltaTime)
+		{
+			PlayReplay(ReplayName, true);
+			return false;
+		}));
+	}
+}
+
+void UBlasterReplaySubsystem::Deinitialize()
+{
+	FNetworkReplayDelegates::OnReplayPlaybackComplete.RemoveAll(this);
+
+	if (bProfiling)
+	{
+		EndProfiling(false);
+	}
+
+	Super::Deinitialize();
+}
+
+void UBlasterReplaySubsystem::StartMatchRecording(const UObject* WorldContextObject)
+{
+	if (CVarBlasterReplayAutoRecord.GetValueOnGameThread() == 0) return;
+
+	UBlasterReplaySubsystem* Replay = GetReplaySubsystem(WorldContextObject);
+	if (Replay && !Replay->bRecordingMatch)
+	{
+		Replay->StartRecording(FString::Printf(TEXT("Blaster_%s_%s"), *WorldContextObject->GetWorld()->GetMapName(), *FDateTime::Now().ToString()));
+		Replay->bRecordingMatch = true;
+	}
+}
+
+void UBlasterReplaySubsystem::StopMatchRecording(const UObject* WorldContextObject)
+{
+	UBlasterReplaySubsystem* Replay = GetReplaySubsystem(WorldContextObject);
+	if (Replay && Replay->bRecordingMatch)
+	{
+		Replay->StopRecording();
+	}
+}
+
+void UBlasterReplaySubsystem::StartRecording(const FString& ReplayName)
+{
+	const UWorld* World = GetWorld();
+	if (World == nullptr || World->IsPlayingReplay()) return;
+
+	UE_LOG(LogBlasterReplay, Log, TEXT("Recording replay %s"), *ReplayName);
+	GetGameInstance()->StartRecordingReplay(ReplayName, ReplayName);
+}
+
+void UBlasterReplaySubsystem::StopRecording()
+{
+	bRecordingMatch = false;
+	GetGameInstance()->StopRecordingReplay();
+}
+
+void UBlasterReplaySubsystem::PlayReplay(const FString& ReplayName, bool bProfile)
+{
+	if (bProfiling)
+	{
+		EndProfiling(false);
+	}
+
+	if (!GetGameInstance()->PlayReplay(ReplayName))
+	{
+		UE_LOG(LogBlasterReplay, Error, TEXT("Could not play replay %s"), *ReplayName);
+		return;
+	}
+
+	if (bProfile)
+	{
+		BeginProfiling(ReplayName);
+	}
+}
+
+void UBlasterReplaySubsystem::BeginProfiling(const FString& ReplayName)
+{
+	bProfiling = true;
+	ProfiledReplayName = ReplayName;
+	FrameSamples.Reset();
+	LastFrameTime = FPlatformTime::Seconds();
+
+	// A fixed timestep makes the engine tick without waiting, so the replay plays as fast as frames can be produced
+	bSavedUseFixedTimeStep = FApp::UseFixedTimeStep();
+	SavedFixedDeltaTime = FApp::GetFixedDeltaTime();
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(CVarBlasterReplayProfileDeltaTime.GetValueOnGameThread());
+
+	ProfileTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UBlasterReplaySubsystem::TickProfiling));
+}
+
+bool UBlasterReplaySubsystem::TickProfiling(float DeltaTime)
+{
+	const UWorld* World = GetWorld();
+	const UDemoNetDriver* DemoNetDriver = World ? World->GetDemoNetDriver() : nullptr;
+	if (DemoNetDriver == nullptr) return true;
+
+	const double Now = FPlatformTime::Seconds();
+	FFrameSample& Sample = FrameSamples.AddDefaulted_GetRef();
+	Sample.DemoTime = DemoNetDriver->GetDemoCurrentTime();
+	Sample.FrameMs = static_cast<float>((Now - LastFrameTime) * 1000.0);
+	Sample.GameThreadMs = static_cast<float>(FPlatformTime::ToMilliseconds(GGameThreadTime));
+	LastFrameTime = Now;
+
+	if (Sample.GameThreadMs > CVarBlasterReplaySpikeMs.GetValueOnGameThread())
+	{
+		TRACE_BOOKMARK(TEXT("Replay spike %.1f ms at %.2f s"), Sample.GameThreadMs, Sample.DemoTime);
+	}
+	return true;
+}
+
+void UBlasterReplaySubsystem::EndProfiling(bool bCompleted)
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(ProfileTickerHandle);
+	FApp::SetUseFixedTimeStep(bSavedUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(SavedFixedDeltaTime);
+	bProfiling = false;
+
+	if (bCompleted)
+	{
+		WriteProfile();
+	}
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("ReplayProfileExit")))
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UBlasterReplaySubsystem::WriteProfile() const
+{
+	if (FrameSamples.IsEmpty()) return;
+
+	FString CSV(TEXT("DemoTime,FrameMs,GameThreadMs\n"));
+	TArray<float> GameThreadTimes;
+	GameThreadTimes.Reserve(FrameSamples.Num());
+	for (const FFrameSample& Sample : FrameSamples)
+	{
+		CSV += FString::Printf(TEXT("%.3f,%.3f,%.3f\n"), Sample.DemoTime, Sample.FrameMs, Sample.GameThreadMs);
+		GameThreadTimes.Add(Sample.GameThreadMs);
+	}
+
+	const FString Filename = FPaths::ProfilingDir() / TEXT("Replays") / FString::Printf(TEXT("%s_%s.csv"), *ProfiledReplayName, *FDateTime::Now().ToString());
+	const bool bSaved = FFileHelper::SaveStringToFile(CSV, *Filename);
+
+	GameThreadTimes.Sort();
+	const float Median = GameThreadTimes[GameThreadTimes.Num() / 2];
+	const float P99 = GameThreadTimes[FMath::Min(GameThreadTimes.Num() * 99 / 100, GameThreadTimes.Num() - 1)];
+	UE_LOG(LogBlasterReplay, Display, TEXT("Replay %s: %d frames, game thread median %.2f ms, p99 %.2f ms, max %.2f ms. Timings %s %s"),
+		*ProfiledReplayName, FrameSamples.Num(), Median, P99, GameThreadTimes.Last(),
+		bSaved ? TEXT("written to") : TEXT("could not be written to"), *Filename);
+}
+
+void UBlasterReplaySubsystem::OnReplayPlaybackComplete(UWorld* World)
+{
+	if (bProfiling)
+	{
+		EndProfiling(true);
+	}
+}
@@ -0,0 +1,184 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterServerDensitySubsystem.h"
+
+#include "AssetRegistry/IAssetRegistry.h"
+#include "CoreGlobals.h"
+#include "Engine/AssetManager.h"
+#include "Engine/NetDriver.h"
+#include "Engine/StreamableManager.h"
+#include "Engine/World.h"
+#include "GameMode/LobbyGameMode.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/Fork.h"
+#include "Misc/PackageName.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBlasterServerDensity, Log, All);
+
+static TAutoConsoleVariable<int32> CVarBlasterForkedTickRate(
+	TEXT("blaster.Server.ForkedTickRate"),
+	30,
+	TEXT("Server tick rate of each forked match process. 0 keeps NetServerMaxTickRate"),
+	ECVF_Default);
+
+static TAutoConsoleVariable<float> CVarBlasterBudgetReportInterval(
+	TEXT("blaster.Server.BudgetReportInterval"),
+	60.f,
+	TEXT("Seconds between reports of frames over the tick budget in a forked match process"),
+	ECVF_Default);
+
+bool UBlasterServerDensitySubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return IsRunningDedicatedServer() && FForkProcessHelper::IsForkRequested() && Super::ShouldCreateSubsystem(Outer);
+}
+
+void UBlasterServerDensitySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	FCoreDelegates::OnParentPreFork.AddUObject(this, &UBlasterServerDensitySubsystem::OnParentPreFork);
+	FCoreDelegates::OnPostFork.AddUObject(this, &UBlasterServerDensitySubsystem::OnPostFork);
+}
+
+void UBlasterServerDensitySubsystem::Deinitialize()
+{
+	FCoreDelegates::OnParentPreFork.RemoveAll(this);
+	FCoreDelegates::OnPostFork.RemoveAll(this);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	FTSTicker::GetCoreTicker().RemoveTicker(BudgetTickerHandle);
+
+	if (SharedAssetsHandle.IsValid())
+	{
+		SharedAssetsHandle->ReleaseHandle();
+		SharedAssetsHandle.Reset();
+	}
+
+	Super::Deinitialize();
+}
+
+void UBlasterServerDensitySubsystem::OnParentPreFork()
+{
+	if (SharedAssetsHandle.IsValid()) return;
+
+	// The lobby game mode is configured in Blueprint, so read the lists from the one the lobby world is running rather than the native defaults
+	const UWorld* World = GetWorld();
+	const ALobbyGameMode* LobbyGameMode = World ? World->GetAuthGameMode<ALobbyGameMode>() : nullptr;
+	if (LobbyGameMode == nullptr)
+	{
+		UE_LOG(LogBlasterServerDensity, Warning, TEXT("Forking from a world without a lobby game mode, no match assets will be shared"));
+		return;
+	}
+
+	// Load everything a match needs once, here, instead of once per child
+	TArray<FSoftObjectPath> Assets;
+	for (const FSoftObjectPath& Asset : LobbyGameMode->GetPreloadAssets())
+	{
+		AddSharedAsset(Asset, Assets);
+	}
+	AddMapDependencies(FName(*LobbyGameMode->GetTravelMap()), Assets);
+
+	const double StartTime = FPlatformTime::Seconds();
+	SharedAssetsHandle = UAssetManager::GetStreamableManager().RequestSyncLoad(Assets);
+
+	// Collect now so the children do not each dirty their pages by collecting the same garbage
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS, true);
+
+	UE_LOG(LogBlasterServerDensity, Display, TEXT("Loaded %d shared match assets before forking in %.2f s"), Assets.Num(), FPlatformTime::Seconds() - StartTime);
+}
+
+void UBlasterServerDensitySubsystem::AddSharedAsset(const FSoftObjectPath& Asset, TArray<FSoftObjectPath>& OutAssets)
+{
+	// A map in the preload list is shared through its dependencies, never its world
+	const FAssetData AssetData = IAssetRegistry::GetChecked().GetAssetByObjectPath(Asset);
+	if (AssetData.IsValid() && AssetData.AssetClassPath == UWorld::StaticClass()->GetClassPathName())
+	{
+		AddMapDependencies(AssetData.PackageName, OutAssets);
+	}
+	else
+	{
+		OutAssets.AddUnique(Asset);
+	}
+}
+
+void UBlasterServerDensitySubsystem::AddMapDependencies(FName MapPackage, TArray<FSoftObjectPath>& OutAssets)
+{
+	// Not the map itself: a world package held here would outlive the children's map to map travel and trip the world leak check
+	IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	TArray<FName> Dependencies;
+	AssetRegistry.GetDependencies(MapPackage, Dependencies, UE::AssetRegistry::EDependencyCategory::Package, UE::AssetRegistry::EDependencyQuery::Hard);
+
+	for (const FName Dependency : Dependencies)
+	{
+		if (FPackageName::IsScriptPackage(Dependency.ToString())) continue;
+
+		TArray<FAssetData> PackageAssets;
+		AssetRegistry.GetAssetsByPackageName(Dependency, PackageAssets);
+		for (const FAssetData& Asset : PackageAssets)
+		{
+			if (Asset.AssetClassPath != UWorld::StaticClass()->GetClassPathName())
+			{
+				OutAssets.AddUnique(Asset.GetSoftObjectPath());
+			}
+		}
+	}
+}
+
+void UBlasterServerDensitySubsystem::OnPostFork(EForkProcessRole Role)
+{
+	if (Role != EForkProcessRole::Child) return;
+
+	// Travel replaces the net driver settings, so apply the budget after every map load too
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UBlasterServerDensitySubsystem::OnPostLoadMap);
+	ApplyTickRate(GetWorld());
+
+	LastReportTime = FPlatformTime::Seconds();
+	BudgetTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UBlasterServerDensitySubsystem::TickBudget));
+}
+
+void UBlasterServerDensitySubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	ApplyTickRate(LoadedWorld);
+}
+
+void UBlasterServerDensitySubsystem::ApplyTickRate(UWorld* World) const
+{
+	const int32 TickRate = CVarBlasterForkedTickRate.GetValueOnGameThread();
+	UNetDriver* NetDriver = World ? World->GetNetDriver() : nullptr;
+	if (NetDriver && TickRate > 0)
+	{
+		NetDriver->SetNetServerMaxTickRate(TickRate);
+	}
+}
+
+bool UBlasterServerDensitySubsystem::TickBudget(float DeltaTime)
+{
+	const int32 TickRate = CVarBlasterForkedTickRate.GetValueOnGameThread();
+	if (TickRate <= 0) return true;
+
+	// Game thread work only, so the time spent idling up to the tick rate does not count against the budget
+	const double BudgetMs = 1000.0 / TickRate;
+	const double FrameMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	NumFrames++;
+	if (FrameMs > BudgetMs)
+	{
+		NumFramesOverBudget++;
+	}
+	WorstFrameMs = FMath::Max(WorstFrameMs, FrameMs);
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastReportTime >= CVarBlasterBudgetReportInterval.GetValueOnGameThread())
+	{
+		if (NumFramesOverBudget > 0)
+		{
+			UE_LOG(LogBlasterServerDensity, Warning, TEXT("%d of %d frames went over the %.1f ms tick budget, worst %.1f ms"), NumFramesOverBudget, NumFrames, BudgetMs, WorstFrameMs);
+		}
+		NumFrames = 0;
+		NumFramesOverBudget = 0;
+		WorstFrameMs = 0.0;
+		LastReportTime = Now;
+	}
+	return true;
+}
@@ -0,0 +1,134 @@
+// Copyright Peter Carsten Collins (2024)
+
+
+#include "Subsystems/BlasterTravelTimingSubsystem.h"
+
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/MiscTrace.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogBlasterTravelTiming, Log, All);
+
+void UBlasterTravelTimingSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	SessionStartTime = FPlatformTime::Seconds();
+	LastMarkerTime = SessionStartTime;
+
+	// Forked servers, headless clients and PIE instances start within the same second, so each gets its own file
+	FString InstanceName = FString::Printf(TEXT("%s_%u"), *FDateTime::Now().ToString(), FPlatformProcess::GetCurrentProcessId());
+	const FWorldContext* WorldContext = GetGameInstance()->GetWorldContext();
+	if (WorldContext && WorldContext->PIEInstance != INDEX_NONE)
+	{
+		InstanceName += FString::Printf(TEXT("_PIE%d"), WorldContext->PIEInstance);
+	}
+	CSVFilename = FPaths::ProfilingDir() / TEXT("TravelTiming") / FString::Printf(TEXT("TravelTiming_%s.csv"), *InstanceName);
+	FFileHelper::SaveStringToFile(FString(TEXT("Seconds,SinceLast,NetMode,Marker,Detail\n")), *CSVFilename);
+
+	// These delegates fire for every game instance in the process, so each handler checks the world belongs to this one
+	FCoreUObjectDelegates::PreLoadMapWithContext.AddUObject(this, &UBlasterTravelTimingSubsystem::OnPreLoadMap);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UBlasterTravelTimingSubsystem::OnPostLoadMap);
+	FWorldDelegates::OnSeamlessTravelStart.AddUObject(this, &UBlasterTravelTimingSubsystem::OnSeamlessTravelStart);
+	FWorldDelegates::OnSeamlessTravelTransition.AddUObject(this, &UBlasterTravelTimingSubsystem::OnSeamlessTravelTransition);
+}
+
+void UBlasterTravelTimingSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PreLoadMapWithContext.RemoveAll(this);
+	FCoreUObjectDelegates::PostLoadMapWithWorld.RemoveAll(this);
+	FWorldDelegates::OnSeamlessTravelStart.RemoveAll(this);
+	FWorldDelegates::OnSeamlessTravelTransition.RemoveAll(this);
+
+	Super::Deinitialize();
+}
+
+void UBlasterTravelTimingSubsystem::Mark(const UObject* WorldContextObject, FName Marker, const FString& Detail, bool bOncePerMap)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+	if (UBlasterTravelTimingSubsystem* TravelTiming = GameInstance ? GameInstance->GetSubsystem<UBlasterTravelTimingSubsystem>() : nullptr)
+	{
+		TravelTiming->AddMarker(Marker, Detail, bOncePerMap);
+	}
+}
+
+void UBlasterTravelTimingSubsystem::AddMarker(FName Marker, const FString& Detail, bool bOncePerMap)
+{
+	if (bOncePerMap)
+	{
+		bool bAlreadyMarked = false;
+		MarkersSinceMapLoad.Add(Marker, &bAlreadyMarked);
+		if (bAlreadyMarked) return;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	const double Seconds = Now - SessionStartTime;
+	const double SinceLast = Now - LastMarkerTime;
+	LastMarkerTime = Now;
+
+	TRACE_BOOKMARK(TEXT("Blaster %s %s"), *Marker.ToString(), *Detail);
+	UE_LOG(LogBlasterTravelTiming, Log, TEXT("%8.3f (+%.3f) %s %s"), Seconds, SinceLast, *Marker.ToString(), *Detail);
+
+	// Appended per marker so the timings survive a crash or a killed headless process
+	const FString Row = FString::Printf(TEXT("%.4f,%.4f,%s,%s,%s\n"), Seconds, SinceLast, *GetNetModeName(), *Marker.ToString(), *Detail.Replace(TEXT(","), TEXT(";")));
+	FFileHelper::SaveStringToFile(Row, *CSVFilename, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+}
+
+void UBlasterTravelTimingSubsystem::OnPreLoadMap(const FWorldContext& WorldContext, const FString& MapName)
+{
+	if (WorldContext.OwningGameInstance != GetGameInstance()) return;
+
+	AddMarker(TEXT("PreLoadMap"), MapName, false);
+}
+
+void UBlasterTravelTimingSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (!IsOwnWorld(LoadedWorld)) return;
+
+	MarkersSinceMapLoad.Reset();
+	AddMarker(TEXT("PostLoadMap"), LoadedWorld->GetMapName(), false);
+}
+
+void UBlasterTravelTimingSubsystem::OnSeamlessTravelStart(UWorld* World, const FString& MapName)
+{
+	if (!IsOwnWorld(World)) return;
+
+	AddMarker(TEXT("SeamlessTravelStart"), MapName, false);
+}
+
+void UBlasterTravelTimingSubsystem::OnSeamlessTravelTransition(UWorld* World)
+{
+	if (!IsOwnWorld(World)) return;
+
+	AddMarker(TEXT("SeamlessTravelTransition"), World->GetMapName(), false);
+}
+
+bool UBlasterTravelTimingSubsystem::IsOwnWorld(const UWorld* World) const
+{
+	return World && World->GetGameInstance() == GetGameInstance();
+}
+
+FString UBlasterTravelTimingSubsystem::GetNetModeName() const
+{
+	const UWorld* World = GetGameInstance() ? GetGameInstance()->GetWorld() : nullptr;
+	if (World == nullptr) return TEXT("None");
+
+	switch (World->GetNetMode())
+	{
+	case NM_DedicatedServer:
+		return TEXT("DedicatedServer");
+	case NM_ListenServer:
+		return TEXT("ListenServer");
+	case NM_Client:
+		return TEXT("Client");
+	default:
+		return TEXT("Standalone");
+	}
+}
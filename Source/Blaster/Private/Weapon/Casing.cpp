@@ -3,8 +3,8 @@
 
 #include "Weapon/Casing.h"
 
-#include "Kismet/GameplayStatics.h"
 #include "Sound/SoundCue.h"
+#include "Subsystems/BlasterAudioSubsystem.h"
 
 ACasing::ACasing()
 {
@@ -38,7 +38,7 @@ void ACasing::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitive
 {
 	if (CasingSound && !bCasingSoundPlayed)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, CasingSound, GetActorLocation());
+		UBlasterAudioSubsystem::PlaySoundAtLocation(this, CasingSound, GetActorLocation(), EBlasterSoundCategory::EBSC_Casing);
 		bCasingSoundPlayed = true;
 	}
 }
@@ -7,10 +7,11 @@
 #include "Character/BlasterCharacter.h"
 #include "Components/BoxComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
-#include "Kismet/GameplayStatics.h"
 #include "NiagaraComponent.h"
-#include "NiagaraFunctionLibrary.h"
 #include "Sound/SoundCue.h"
+#include "Subsystems/BlasterAudioSubsystem.h"
+#include "Subsystems/BlasterEffectsSubsystem.h"
+#include "Weapon/ProjectileWeapon.h"
 
 AProjectile::AProjectile()
 {
@@ -36,15 +37,19 @@ void AProjectile::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	// Bind callbacks on the server
-	if (HasAuthority())
+	// Bind callbacks on the server. Simulated projectiles only report their hit locally
+	if (bIsCosmetic)
+	{
+		CollisionBox->OnComponentHit.AddDynamic(this, &AProjectile::OnCosmeticHit);
+	}
+	else if (HasAuthority())
 	{
 		CollisionBox->OnComponentHit.AddDynamic(this, &AProjectile::OnHit);
 	}
 
 	if (Tracer)
 	{
-		TracerComponent = UNiagaraFunctionLibrary::SpawnSystemAttached(Tracer, CollisionBox, NAME_None, GetActorLocation(), GetActorRotation(), EAttachLocation::Type::KeepWorldPosition, true);
+		TracerComponent = UBlasterEffectsSubsystem::SpawnEffectAttached(Tracer, CollisionBox, GetActorLocation(), GetActorRotation());
 	}
 }
 
@@ -56,13 +61,22 @@ void AProjectile::Tick(float DeltaTime)
 
 void AProjectile::Destroyed()
 {
+	// Hand the tracer back to the pool rather than destroying it with the projectile
+	UBlasterEffectsSubsystem::ReleaseEffect(TracerComponent);
+	TracerComponent = nullptr;
+
+	if (bIsCosmetic && SpawnEventWeapon.IsValid())
+	{
+		SpawnEventWeapon->ForgetSimulatedProjectile(ProjectileId, this);
+	}
+
 	if (ImpactParticles)
 	{
-		UNiagaraFunctionLibrary::SpawnSystemAtLocation(this, ImpactParticles, GetActorLocation(), (-GetVelocity()).Rotation());
+		UBlasterEffectsSubsystem::SpawnEffectAtLocation(this, ImpactParticles, GetActorLocation(), (-GetVelocity()).Rotation());
 	}
 	if (ImpactSound)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, ImpactSound, GetActorLocation());
+		UBlasterAudioSubsystem::PlaySoundAtLocation(this, ImpactSound, GetActorLocation(), EBlasterSoundCategory::EBSC_Impact);
 	}
 
 	Super::Destroyed();
@@ -70,5 +84,46 @@ void AProjectile::Destroyed()
 
 void AProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	// Clients only learn about the impact of spawn event projectiles through the weapon
+	if (SpawnEventWeapon.IsValid())
+	{
+		SpawnEventWeapon->NotifyProjectileImpact(ProjectileId, GetActorLocation());
+	}
+
 	Destroy();
+}
+
+void AProjectile::OnCosmeticHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	Destroy();
+}
+
+void AProjectile::InitializeFromSpawnEvent(AProjectileWeapon* InSpawnEventWeapon, uint16 InProjectileId, bool bInIsCosmetic)
+{
+	SpawnEventWeapon = InSpawnEventWeapon;
+	ProjectileId = InProjectileId;
+	bIsCosmetic = bInIsCosmetic;
+
+	// Spawn event projectiles never open an actor channel
+	SetReplicates(false);
+}
+
+void AProjectile::CompleteAtImpact(const FVector& ImpactLocation)
+{
+	SetActorLocation(ImpactLocation);
+	Destroy();
+}
+
+void AProjectile::SetInitialSpeed(float Speed)
+{
+	ProjectileMovementComponent->InitialSpeed = Speed;
+	if (ProjectileMovementComponent->MaxSpeed > 0.f)
+	{
+		ProjectileMovementComponent->MaxSpeed = FMath::Max(ProjectileMovementComponent->MaxSpeed, Speed);
+	}
+}
+
+float AProjectile::GetInitialSpeed() const
+{
+	return ProjectileMovementComponent->InitialSpeed;
 }
\ No newline at end of file
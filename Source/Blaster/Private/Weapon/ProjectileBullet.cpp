@@ -4,7 +4,8 @@
 #include "Weapon/ProjectileBullet.h"
 
 #include "GameFramework/Character.h"
-#include "Kismet/GameplayStatics.h"
+#include "GameFramework/DamageType.h"
+#include "Subsystems/BlasterDamageSubsystem.h"
 
 void AProjectileBullet::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
@@ -12,7 +13,7 @@ void AProjectileBullet::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor,
 	{
 		if (AController* OwnerController = OwnerCharacter->Controller)
 		{
-			UGameplayStatics::ApplyDamage(OtherActor, Damage, OwnerController, this, UDamageType::StaticClass());
+			UBlasterDamageSubsystem::QueuePointDamage(OtherActor, Damage, GetActorForwardVector(), Hit, OwnerController, this, UDamageType::StaticClass());
 		}
 	}
 
@@ -4,40 +4,136 @@
 #include "Weapon/ProjectileWeapon.h"
 
 #include "Engine/SkeletalMeshSocket.h"
-#include "Weapon/Projectile.h"
 
-void AProjectileWeapon::Fire(const FVector& HitTarget)
+void AProjectileWeapon::PrepareFire(FWeaponFireParams& Params)
 {
-	Super::Fire(HitTarget);
+	Super::PrepareFire(Params);
 
-	// Only run on the server (this is the case since the weapon is replicated and so HasAuthority is only true on the server)
-	if (!HasAuthority()) return;
+	if (!bUseSpawnEvents || ProjectileClass == nullptr) return;
+
+	FVector SpawnLocation;
+	FVector ShotDirection;
+	if (!GetProjectileSpawn(Params, SpawnLocation, ShotDirection)) return;
+
+	// The spawn event goes out with the fire multicast, so the server's projectile starts from exactly what clients receive
+	Params.bHasProjectileSpawn = true;
+	Params.ProjectileSpawn.Origin = SpawnLocation;
+	Params.ProjectileSpawn.Direction = ShotDirection;
+	Params.ProjectileSpawn.Speed = static_cast<uint16>(FMath::Clamp(FMath::RoundToInt(ProjectileClass->GetDefaultObject<AProjectile>()->GetInitialSpeed()), 0, MAX_uint16));
+	Params.ProjectileSpawn.ProjectileId = NextProjectileId++;
+}
+
+void AProjectileWeapon::Fire(const FWeaponFireParams& Params)
+{
+	Super::Fire(Params);
+
+	if (!HasAuthority())
+	{
+		if (Params.bHasProjectileSpawn)
+		{
+			SpawnSimulatedProjectile(Params.ProjectileSpawn);
+		}
+		return;
+	}
 
 	// Spawn the projectile
 	APawn* InstigatorPawn = Cast<APawn>(GetOwner());
+	UWorld* World = GetWorld();
+	if (ProjectileClass == nullptr || InstigatorPawn == nullptr || World == nullptr) return;
+
+	FVector SpawnLocation;
+	FVector ShotDirection;
+	if (Params.bHasProjectileSpawn)
+	{
+		SpawnLocation = Params.ProjectileSpawn.Origin;
+		ShotDirection = Params.ProjectileSpawn.Direction;
+	}
+	else if (!GetProjectileSpawn(Params, SpawnLocation, ShotDirection))
+	{
+		return;
+	}
+
+	const FTransform SpawnTransform(ShotDirection.Rotation(), SpawnLocation);
+	AProjectile* Projectile = World->SpawnActorDeferred<AProjectile>(ProjectileClass, SpawnTransform, GetOwner(), InstigatorPawn);
+	if (Projectile == nullptr) return;
+
+	if (Params.bHasProjectileSpawn)
+	{
+		Projectile->InitializeFromSpawnEvent(this, Params.ProjectileSpawn.ProjectileId, false);
+	}
+	Projectile->FinishSpawning(SpawnTransform);
+}
+
+bool AProjectileWeapon::GetProjectileSpawn(const FWeaponFireParams& Params, FVector& OutLocation, FVector& OutDirection) const
+{
 	const USkeletalMeshSocket* MuzzleFlashSocket = GetWeaponMesh()->GetSocketByName(FName("MuzzleFlashSocket"));
-	if (MuzzleFlashSocket)
+	if (MuzzleFlashSocket == nullptr) return false;
+
+	const FTransform MuzzleFlashSocketTransform = MuzzleFlashSocket->GetSocketTransform(GetWeaponMesh());
+	OutLocation = MuzzleFlashSocketTransform.GetLocation();
+	OutDirection = FWeaponSpreadModel::GetShotDirection(Params.HitTarget - OutLocation, Params.Spread, Params.SpreadSeed, GetSpreadParams());
+
+	if (Params.TimeOffset > 0.f && ProjectileClass)
 	{
-		const FTransform MuzzleFlashSocketTransform = MuzzleFlashSocket->GetSocketTransform(GetWeaponMesh());
-		const FVector ToTarget = HitTarget - MuzzleFlashSocketTransform.GetLocation();
-		const FRotator ToTargetRotation = ToTarget.Rotation();
+		OutLocation = GetSubFrameSpawnLocation(OutLocation, OutDirection, ProjectileClass->GetDefaultObject<AProjectile>()->GetInitialSpeed() * Params.TimeOffset);
+	}
+	return true;
+}
 
-		if (ProjectileClass && InstigatorPawn)
-		{
-			FActorSpawnParameters SpawnParams;
-			SpawnParams.Owner = GetOwner();
-			SpawnParams.Instigator = InstigatorPawn;
-
-			UWorld* World = GetWorld();
-			if (World)
-			{
-				World->SpawnActor<AProjectile>(
-					ProjectileClass, 
-					MuzzleFlashSocketTransform.GetLocation(),
-					ToTargetRotation,
-					SpawnParams
-				);
-			}
-		}
+FVector AProjectileWeapon::GetSubFrameSpawnLocation(const FVector& MuzzleLocation, const FVector& Direction, float Distance) const
+{
+	// A shot that was due earlier in the frame has already travelled part of the way, but never through a wall
+	const FVector End = MuzzleLocation + Direction * FMath::Min(Distance, MaxSubFrameSpawnDistance);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileSubFrameSpawn), false, this);
+	QueryParams.AddIgnoredActor(GetOwner());
+
+	FHitResult Hit;
+	if (GetWorld()->LineTraceSingleByChannel(Hit, MuzzleLocation, End, ECC_Visibility, QueryParams))
+	{
+		return MuzzleLocation + Direction * FMath::Max(Hit.Distance - 1.f, 0.f);
+	}
+	return End;
+}
+
+void AProjectileWeapon::NotifyProjectileImpact(uint16 ProjectileId, const FVector& ImpactLocation)
+{
+	const FVector_NetQuantize QuantizedImpactLocation(ImpactLocation);
+	MulticastProjectileImpact(ProjectileId, QuantizedImpactLocation);
+}
+
+void AProjectileWeapon::SpawnSimulatedProjectile(const FProjectileSpawnEvent& SpawnEvent)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || ProjectileClass == nullptr) return;
+
+	const FTransform SpawnTransform(FVector(SpawnEvent.Direction).Rotation(), SpawnEvent.Origin);
+	AProjectile* Projectile = World->SpawnActorDeferred<AProjectile>(ProjectileClass, SpawnTransform, GetOwner(), Cast<APawn>(GetOwner()));
+	if (Projectile == nullptr) return;
+
+	Projectile->InitializeFromSpawnEvent(this, SpawnEvent.ProjectileId, true);
+	Projectile->SetInitialSpeed(SpawnEvent.Speed);
+	Projectile->FinishSpawning(SpawnTransform);
+
+	SimulatedProjectiles.Add(SpawnEvent.ProjectileId, Projectile);
+}
+
+void AProjectileWeapon::ForgetSimulatedProjectile(uint16 ProjectileId, const AProjectile* Projectile)
+{
+	// Ids wrap around, so only forget the entry if it is still this projectile's
+	const TWeakObjectPtr<AProjectile>* SimulatedProjectile = SimulatedProjectiles.Find(ProjectileId);
+	if (SimulatedProjectile && (!SimulatedProjectile->IsValid() || SimulatedProjectile->Get() == Projectile))
+	{
+		SimulatedProjectiles.Remove(ProjectileId);
+	}
+}
+
+void AProjectileWeapon::MulticastProjectileImpact_Implementation(uint16 ProjectileId, const FVector_NetQuantize& ImpactLocation)
+{
+	if (HasAuthority()) return;
+
+	TWeakObjectPtr<AProjectile> Projectile;
+	if (SimulatedProjectiles.RemoveAndCopyValue(ProjectileId, Projectile) && Projectile.IsValid())
+	{
+		Projectile->CompleteAtImpact(ImpactLocation);
 	}
 }
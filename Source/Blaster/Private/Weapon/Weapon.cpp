@@ -9,6 +9,7 @@
 #include "Engine/SkeletalMeshSocket.h"
 #include "Net/UnrealNetwork.h"
 #include "PlayerController/BlasterPlayerController.h"
+#include "Subsystems/BlasterPickupSubsystem.h"
 #include "Weapon/Casing.h"
 
 AWeapon::AWeapon()
@@ -26,7 +27,7 @@ AWeapon::AWeapon()
 	AreaSphere = CreateDefaultSubobject<USphereComponent>("AreaSphere");
 	AreaSphere->SetupAttachment(RootComponent);
 	AreaSphere->SetCollisionResponseToAllChannels(ECR_Ignore); 
-	AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision); // Start off with a disabled AreaSphere
+	AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision); // Only its radius is used, by the pickup subsystem
 
 	PickupWidget = CreateDefaultSubobject<UWidgetComponent>("PickupWidget");
 	PickupWidget->SetupAttachment(RootComponent);
@@ -65,38 +66,27 @@ void AWeapon::BeginPlay()
 		PickupWidget->SetVisibility(false);
 	}
 
-	if (HasAuthority())
+	if (HasAuthority() && WeaponState != EWeaponState::EWS_Equipped)
 	{
-		// Collisions are only enabled on the server
-		AreaSphere->SetCollisionResponseToChannel(ECC_Pawn, ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		AreaSphere->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::OnSphereBeginOverlap);
-		AreaSphere->OnComponentEndOverlap.AddDynamic(this, &AWeapon::OnSphereEndOverlap);
+		// Pickups are only detected on the server
+		UBlasterPickupSubsystem::RegisterPickup(this);
 	}
 }
 
-void AWeapon::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
-void AWeapon::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	ABlasterCharacter* BlasterCharacter = Cast<ABlasterCharacter>(OtherActor);
-	if (BlasterCharacter)
+	if (HasAuthority())
 	{
-		BlasterCharacter->SetOverlappingWeapon(this);
+		UBlasterPickupSubsystem::UnregisterPickup(this);
 	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
-void AWeapon::OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void AWeapon::Tick(float DeltaTime)
 {
-	ABlasterCharacter* BlasterCharacter = Cast<ABlasterCharacter>(OtherActor);
-	if (BlasterCharacter)
-	{
-		BlasterCharacter->SetOverlappingWeapon(nullptr);
-	}
+	Super::Tick(DeltaTime);
+
 }
 
 void AWeapon::OnRep_WeaponState()
@@ -110,6 +100,8 @@ void AWeapon::OnRep_WeaponState()
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 		break;
 	case EWeaponState::EWS_Dropped:
+		// A weapon carried in an inactive slot was hidden, and clients never see it leave the inventory
+		WeaponMesh->SetVisibility(true);
 		WeaponMesh->SetSimulatePhysics(true);
 		WeaponMesh->SetEnableGravity(true);
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
@@ -149,7 +141,10 @@ void AWeapon::SetWeaponState(EWeaponState State)
 	{
 	case EWeaponState::EWS_Equipped:
 		ShowPickupWidget(false);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		if (HasAuthority())
+		{
+			UBlasterPickupSubsystem::UnregisterPickup(this);
+		}
 		WeaponMesh->SetSimulatePhysics(false);
 		WeaponMesh->SetEnableGravity(false);
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
@@ -157,8 +152,9 @@ void AWeapon::SetWeaponState(EWeaponState State)
 	case EWeaponState::EWS_Dropped:
 		if (HasAuthority())
 		{
-			AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+			UBlasterPickupSubsystem::RegisterPickup(this);
 		}
+		WeaponMesh->SetVisibility(true);
 		WeaponMesh->SetSimulatePhysics(true);
 		WeaponMesh->SetEnableGravity(true);
 		WeaponMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
@@ -166,12 +162,21 @@ void AWeapon::SetWeaponState(EWeaponState State)
 	}
 }
 
+float AWeapon::GetPickupRadius() const
+{
+	return AreaSphere->GetScaledSphereRadius();
+}
+
 void AWeapon::ShowPickupWidget(bool bShowWidget)
 {
 	if (PickupWidget) PickupWidget->SetVisibility(bShowWidget);
 }
 
-void AWeapon::Fire(const FVector& HitTarget)
+void AWeapon::PrepareFire(FWeaponFireParams& Params)
+{
+}
+
+void AWeapon::Fire(const FWeaponFireParams& Params)
 {
 	PlayFiringAnimation();
 	SpawnCasing();
@@ -0,0 +1,40 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "BlasterCharacterMovementComponent.generated.h"
+
+/**
+ * Character movement that carries the aiming state in saved moves so that aim walk speed is predicted and replayed
+ */
+UCLASS()
+class BLASTER_API UBlasterCharacterMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_Blaster;
+
+	//~ Begin UCharacterMovementComponent interface
+public:
+	virtual float GetMaxSpeed() const override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+protected:
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	//~ End UCharacterMovementComponent interface
+
+public:
+	// Set the aiming state that is saved with each move
+	void SetWantsToAim(bool bInWantsToAim) { bWantsToAim = bInWantsToAim; }
+
+	// Return true if the character is moving at aim speed
+	bool WantsToAim() const { return bWantsToAim; }
+
+	// Maximum ground speed while aiming
+	UPROPERTY(EditAnywhere, Category = "Character Movement: Walking")
+	float AimWalkSpeed = 400.f;
+
+private:
+	bool bWantsToAim = false;
+};
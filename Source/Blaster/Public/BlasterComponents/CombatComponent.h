@@ -6,6 +6,9 @@
 #include "HUD/BlasterHUD.h"
 #include "Components/ActorComponent.h"
 #include "Blaster/BlasterTypes/CombatState.h"
+#include "Blaster/BlasterTypes/InputState.h"
+#include "Blaster/BlasterTypes/WeaponFireParams.h"
+#include "Blaster/BlasterTypes/WeaponSpread.h"
 #include "Weapon/WeaponTypes.h"
 #include "CombatComponent.generated.h"
 
@@ -32,52 +35,89 @@ public:
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 	//~ End UActorComponent interface
 
-	/** Equips a weapon to the character */
+	/** Puts a weapon in its inventory slot, dropping the weapon already there */
 	void EquipWeapon(AWeapon* WeaponToEquip);
 
+	// Equip the weapon the character is overlapping
+	void EquipButtonPressed();
+
+	// Switch to the next occupied inventory slot
+	void SwapWeaponButtonPressed();
+
+	// Drop every carried weapon (server only)
+	void DropWeapons();
+
+	AWeapon* GetWeaponInSlot(EInventorySlot Slot) const { return Inventory[static_cast<uint8>(Slot)]; }
+
 	// Reload functions
 	void ReloadButtonPressed();
 
 	// Fire functions
 	void FireButtonPressed(bool bInIsFireButtonPressed);
+
+	// Fire a shot now if the equipped weapon is ready
 	void Fire();
 
 	bool CanFire() const;
 
+	// Apply an aiming state received through the character's saved moves (server only)
+	void SetAimingFromMovement(bool bInIsAiming);
+
 protected:
 	// Aiming state functions
 	void SetAiming(bool bInIsAiming);
 
 	// RPCs
-	UFUNCTION(Server, Reliable)
-	void ServerSetAiming(bool bInIsAiming);
-	UFUNCTION(Server, Reliable)
-	void ServerFire(const FVector_NetQuantize& TraceHitTarget);
+	UFUNCTION(Server, Unreliable)
+	void ServerSendInputState(const FBlasterInputState& InputState);
 	UFUNCTION(NetMulticast, Reliable)
-	void MulticastFire(const FVector_NetQuantize& TraceHitTarget);
-	UFUNCTION(Server, Reliable)
-	void ServerReload();
+	void MulticastFire(const FWeaponFireParams& Params);
+	// Undo a swap the owning client predicted but the server refused
+	UFUNCTION(Client, Reliable)
+	void ClientRejectSwap(uint8 ServerActiveSlot);
 	UFUNCTION()
 	void HandleReload();
 
+	// Server-side handling of combat intents
+	void ServerHandleFire(const FWeaponFireParams& Params);
+	void ServerHandleReload();
+	void ServerHandleEquip();
+	// Return false if the swap was refused
+	bool ServerHandleSwap(uint8 Slot);
+
+	// Client-side input state management
+	void MarkInputStateDirty();
+	void FlushInputState();
+
 	// Called from animnotify to exit the reloading state
 	UFUNCTION(BlueprintCallable)
 	void FinishReloading();
 
 	UFUNCTION()
-	void OnRep_EquippedWeapon();
+	void OnRep_Inventory();
 
-	// Fire timer management
-	void FireTimerStart();
-	void FireTimerFinish();
+	UFUNCTION()
+	void OnRep_ActiveSlot();
+
+	// Point EquippedWeapon at the weapon in the active slot and show only that weapon
+	void RefreshEquippedWeapon();
+
+	// Attach a carried weapon to the hand, where it stays until dropped
+	void AttachWeaponToHand(AWeapon* Weapon);
+
+	void DropWeaponInSlot(uint8 Slot);
+
+	// Fire scheduling. Automatic fire is driven from the tick rather than a timer per shot
+	void UpdateFireScheduler(float DeltaTime);
+	void FireShot(float TimeOffset);
 
 	// HUD and crosshair functions
 	void TraceUnderCrosshairs(FHitResult& TraceHitResult);
 	void UpdateHUDCrosshairs(float DeltaTime);
-	void UpdateCrosshairVelocityFactor(float DeltaTime);
-	void UpdateCrosshairInAirFactor(float DeltaTime);
-	void UpdateCrosshairAimFactor(float DeltaTime);
-	void UpdateCrosshairShootFactor(float DeltaTime);
+
+	// Spread shared by the crosshairs and the server's shots
+	void UpdateSpreadModel(float DeltaTime);
+	const FWeaponSpreadParams& GetSpreadParams() const;
 
 	// Camera and FOV
 	void UpdateCameraFOV(float DeltaTime);
@@ -88,36 +128,72 @@ private:
 	ABlasterPlayerController* Controller = nullptr;
 	ABlasterHUD* HUD = nullptr;
 
-	// Weapon and aiming states
-	UPROPERTY(ReplicatedUsing = OnRep_EquippedWeapon)
+	// Weapons carried in each inventory slot. Carried weapons stay attached to the hand and only the active one is visible
+	UPROPERTY(ReplicatedUsing = OnRep_Inventory)
+	TObjectPtr<AWeapon> Inventory[static_cast<uint8>(EInventorySlot::EIS_MAX)];
+
+	// Inventory slot of the weapon in hand. A swap only replicates this byte
+	UPROPERTY(ReplicatedUsing = OnRep_ActiveSlot)
+	uint8 ActiveSlot = 0;
+
+	// Weapon in the active slot, cached from Inventory and ActiveSlot on every machine
+	UPROPERTY(Transient)
 	TObjectPtr<AWeapon> EquippedWeapon = nullptr;
+
+	// Aiming state
 	UPROPERTY(Replicated)
 	bool bIsAiming = false;
 
-	// Fire button state and timer
+	// Combat input state most recently sent by this client
+	FBlasterInputState LocalInputState;
+
+	// Number of frames the local input state is still sent for, to cover packet loss on the unreliable RPC
+	int32 InputStateSendsRemaining = 0;
+
+	// Number of times every input state change is sent
+	UPROPERTY(EditAnywhere, Category = "Combat|Network")
+	int32 InputStateRedundantSends = 3;
+
+	// Combat input state most recently received by the server
+	FBlasterInputState LastServerInputState;
+
+	// Swap counter of the last input state the server applied, so the owner knows when to stop resending a swap
+	UPROPERTY(Replicated)
+	uint8 AckedSwapCount = 0;
+
+	// Maximum number of shots the server accepts from a single input state
+	UPROPERTY(EditAnywhere, Category = "Combat|Network")
+	uint8 MaxShotsPerInputState = 4;
+
+	// Fire button state
 	bool bIsFireButtonPressed = false;
-	FTimerHandle FireTimer;
-	bool bIsFiring = false;
+
+	// Seconds until the equipped weapon can fire again. Each shot adds the weapon's FireDelay, so the leftover time of a frame carries into
+	// the next shot and fire rate is exact at any frame rate
+	float FireCooldown = 0.f;
+
+	// Most shots fired in one frame, so a hitch doesn't turn into a burst
+	UPROPERTY(EditAnywhere, Category = "Combat")
+	int32 MaxShotsPerFrame = 4;
 
 	// HUD crosshair properties
 	FHUDPackage HUDPackage;
-	float CrosshairVelocityFactor = 0.f;
-	float CrosshairInAirFactor = 0.f;
-	float CrosshairAimFactor = 0.f;
-	float CrosshairShootFactor = 0.f;
+
+	// Spread of the equipped weapon, run on the owning client and the server
+	FWeaponSpreadModel SpreadModel;
+
+	// Shots fired in this life, the index each shot's spread seed is made from. The server advances it by the shots in each input state
+	uint32 ShotsFired = 0;
+
+	// Picked by the server when the character spawns and mixed into every spread seed, so patterns differ between lives
+	UPROPERTY(Replicated)
+	uint32 ShotSeedSalt = 0;
 
 	UPROPERTY(EditAnywhere)
 	float BaseWalkSpeed = 600.f;
 	UPROPERTY(EditAnywhere)
 	float AimWalkSpeed = 400.f;
 
-	// Crosshair spread properties
-	float CrosshairBaselineSpread = 0.5f;
-	float MaxCrosshairVelocityFactor = 1.f;
-	float MaxCrosshairInAirFactor = 2.f;
-	float MaxCrosshairAimFactor = -0.58f;
-	float MaxCrosshairShootFactor = 1.f;
-
 	// Aiming and FOV properties
 	float DefaultFOV;
 	float CurrentFOV;
@@ -136,7 +212,11 @@ private:
 	UFUNCTION()
 	void OnRep_CarriedAmmo();
 
-	TMap<EWeaponType, int32> CarriedAmmoMap;
+	// Carried ammo of every weapon type (server only)
+	int32 CarriedAmmoByType[static_cast<uint8>(EWeaponType::EWT_MAX)] = {};
+
+	// Copy the carried ammo of the equipped weapon's type into CarriedAmmo
+	void UpdateCarriedAmmo();
 
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	int32 StartingARAmmo = 30;
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "Components/TimelineComponent.h"
 #include "GameFramework/Character.h"
+#include "Blaster/BlasterTypes/AimState.h"
+#include "Blaster/BlasterTypes/HitRegion.h"
 #include "Blaster/BlasterTypes/TurningInPlace.h"
 #include "Blaster/BlasterTypes/CombatState.h"
 #include "Interfaces/InteractWithCrosshairsInterface.h"
@@ -13,6 +15,7 @@
 class ABlasterPlayerController;
 class ABlasterPlayerState;
 class AWeapon;
+class UBlasterCharacterMovementComponent;
 class UCameraComponent;
 class UCombatComponent;
 class UInputAction;
@@ -28,7 +31,7 @@ class BLASTER_API ABlasterCharacter : public ACharacter, public IInteractWithCro
 	GENERATED_BODY()
 
 public:
-	ABlasterCharacter();
+	ABlasterCharacter(const FObjectInitializer& ObjectInitializer);
 
 	//~ Begin ACharacter interface
 public:
@@ -36,6 +39,7 @@ public:
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const;
 	virtual void PostInitializeComponents() override;
+	virtual void PostNetReceiveLocationAndRotation() override;
 protected:
 	virtual void BeginPlay() override;
 	virtual void Jump() override;
@@ -51,6 +55,9 @@ public:
 	// Set the overlapping weapon
 	void SetOverlappingWeapon(AWeapon* Weapon);
 
+	// Return the overlapping weapon
+	AWeapon* GetOverlappingWeapon() const { return OverlappingWeapon; }
+
 	// Return true if a weapon is equipped
 	bool IsWeaponEquipped() const;
 
@@ -63,6 +70,9 @@ public:
 	// Return the pitch aim offset
 	float GetAO_Pitch() const { return AO_Pitch; }
 
+	// Return the aim rotation, interpolated from replicated aim states on simulated proxies
+	FRotator GetAimRotation() const;
+
 	// Return the turning in place state
 	ETurningInPlace GetTurningInPlace() const { return TurningInPlaceState; }
 
@@ -90,6 +100,18 @@ public:
 
 	ECombatState GetCombatState() const;
 
+	// Return the combat component
+	UCombatComponent* GetCombat() const { return Combat; }
+
+	// Return the damage multiplier of a hit region
+	float GetHitRegionDamageMultiplier(EHitRegion Region) const;
+
+	// Return the bones that start each hit region
+	const TMap<FName, EHitRegion>& GetHitRegionBones() const { return HitRegionBones; }
+
+	// Return the movement component as a Blaster movement component
+	UBlasterCharacterMovementComponent* GetBlasterCharacterMovement() const;
+
 protected:
 	//~ Begin Input section
 	UPROPERTY(EditDefaultsOnly, Category = "Input")
@@ -118,6 +140,9 @@ protected:
 
 	UPROPERTY(EditDefaultsOnly, Category = "Input")
 	TObjectPtr<UInputAction> ReloadAction;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Input")
+	TObjectPtr<UInputAction> SwapWeaponAction;
 	 
 	// Input callback functions
 	void Move(const FInputActionValue& InputActionValue);
@@ -129,6 +154,7 @@ protected:
 	void FireButtonPressed(const FInputActionValue& InputActionValue);
 	void FireButtonReleased(const FInputActionValue& InputActionValue);
 	void ReloadButtonPressed(const FInputActionValue& InputActionValue);
+	void SwapWeaponButtonPressed(const FInputActionValue& InputActionValue);
 	//~ End Input section
 
 	// Update the aim offset for a frame
@@ -137,13 +163,14 @@ protected:
 	// Update the turn in place state for a frame
 	void TurnInPlace(float DeltaTime);
 
-	UFUNCTION(Server, Reliable)
-	void ServerEquipButtonPressed();
-
 	// Callback to damage event
 	UFUNCTION()
 	void ReceiveDamage(AActor* DamagedActor, float Damage, const UDamageType* DamageType, AController* InstigatorController, AActor* DamageCauser);
 
+	// Callback to point damage event, called before ReceiveDamage
+	UFUNCTION()
+	void ReceivePointDamage(AActor* DamagedActor, float Damage, AController* InstigatedBy, FVector HitLocation, UPrimitiveComponent* FHitComponent, FName BoneName, FVector ShotFromDirection, const UDamageType* DamageType, AActor* DamageCauser);
+
 	void UpdateHUDHealth();
 
 	// Poll for any relevant classes and initialize HUD
@@ -181,6 +208,32 @@ private:
 	float AO_Yaw_Interp;
 	FRotator StartingAimRotation;
 
+	/* Begin section: Replicated aim */
+	// Quantized aim pitch written by the server for simulated proxies
+	UPROPERTY(ReplicatedUsing = OnRep_AimState)
+	FBlasterAimState AimState;
+
+	UFUNCTION()
+	void OnRep_AimState();
+
+	// Received aim yaw and pitch, stamped on arrival and sampled AimInterpolationDelay seconds in the past on the synced server clock
+	FBlasterAimInterpolationBuffer AimYawBuffer;
+	FBlasterAimInterpolationBuffer AimPitchBuffer;
+
+	UPROPERTY(EditAnywhere, Category = "Network")
+	float AimInterpolationDelay = 0.1f;
+
+	FRotator InterpolatedAimRotation;
+
+	// Write the aim state on the server or sample the interpolation buffers on simulated proxies
+	void UpdateReplicatedAim();
+
+	bool HasInterpolatedAim() const { return !AimYawBuffer.IsEmpty() || !AimPitchBuffer.IsEmpty(); }
+
+	// Return the server time from the local player controller's synced clock
+	double GetSyncedServerTime() const;
+	/* End section: Replicated aim */
+
 	ETurningInPlace TurningInPlaceState;
 
 	// Animation Montages
@@ -214,6 +267,30 @@ private:
 	void OnRep_Health();
 	/* End section: Player Health */
 
+	/* Begin section: Hit regions */
+	// Bones that start a hit region. Every bone below one of these takes its region, the rest are torso
+	UPROPERTY(EditDefaultsOnly, Category = "Combat|Hit Regions")
+	TMap<FName, EHitRegion> HitRegionBones;
+
+	UPROPERTY(EditAnywhere, Category = "Combat|Hit Regions")
+	float HeadDamageMultiplier = 2.f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat|Hit Regions")
+	float TorsoDamageMultiplier = 1.f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat|Hit Regions")
+	float ArmsDamageMultiplier = 0.75f;
+
+	UPROPERTY(EditAnywhere, Category = "Combat|Hit Regions")
+	float LegsDamageMultiplier = 0.75f;
+
+	// Region and direction of the last damaging hit, packed with BlasterHitInfo. Replicated alongside Health for the hit react
+	UPROPERTY(Replicated)
+	uint8 LastHitInfo = 0;
+
+	FName GetHitReactSectionName() const;
+	/* End section: Hit regions */
+
 	bool bIsEliminated = false;
 
 	/* Begin section: Elimination timer*/
@@ -0,0 +1,22 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "BlasterEventLogToCSVCommandlet.generated.h"
+
+/**
+ * Converts a binary Blaster event log to CSV.
+ * Usage: UnrealEditor-Cmd Blaster.uproject -run=BlasterEventLogToCSV -Input=<Log.blev> [-Output=<Log.csv>]
+ */
+UCLASS()
+class BLASTER_API UBlasterEventLogToCSVCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+	//~ Begin UCommandlet interface
+public:
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet interface
+};
@@ -9,6 +9,12 @@
 class ABlasterCharacter;
 class ABlasterPlayerController;
 
+namespace MatchState
+{
+	// Match has ended and the scores are shown before the map restarts
+	extern BLASTER_API const FName Cooldown;
+}
+
 /**
  * 
  */
@@ -17,11 +23,42 @@ class BLASTER_API ABlasterGameMode : public AGameMode
 {
 	GENERATED_BODY()
 
+public:
+	ABlasterGameMode();
+
 	//~ Begin AGameMode interface
+protected:
+	virtual void GenericPlayerInitialization(AController* C) override;
+	virtual void OnMatchStateSet() override;
+	virtual void PostSeamlessTravel() override;
 	//~ End AGameMode interface
 
 public:
 	virtual void PlayerEliminated(ABlasterCharacter* ElimmedCharacter, ABlasterPlayerController* VictimController, ABlasterPlayerController* AttackerController);
 
 	virtual void RequestRespawn(ACharacter* ElimmedCharacter, AController* ElimmedController);
+
+private:
+	/* Begin section: Match phases */
+	// Seconds of warmup before the match starts
+	UPROPERTY(EditDefaultsOnly, Category = "Match")
+	float WarmupTime = 10.f;
+
+	// Seconds the match lasts
+	UPROPERTY(EditDefaultsOnly, Category = "Match")
+	float MatchTime = 120.f;
+
+	// Seconds of cooldown before the map restarts
+	UPROPERTY(EditDefaultsOnly, Category = "Match")
+	float CooldownTime = 10.f;
+
+	FTimerHandle MatchPhaseTimer;
+
+	// Replicate the phase timing once and schedule the end of the phase
+	void StartMatchPhase(float Duration, void (ABlasterGameMode::*OnPhaseFinished)());
+
+	void WarmupFinished();
+	void MatchFinished();
+	void CooldownFinished();
+	/* End section: Match phases */
 };
@@ -6,16 +6,84 @@
 #include "GameFramework/GameMode.h"
 #include "LobbyGameMode.generated.h"
 
+class APlayerController;
+
 /**
- * GameMode that counts connected players
+ * GameMode that counts connected players, preloads the match assets on the server and clients, then travels to the match map
  */
 UCLASS()
 class BLASTER_API ALobbyGameMode : public AGameMode
 {
 	GENERATED_BODY()
-	
+
 public:
+	ALobbyGameMode();
+
 	//~ Begin AGameMode interface
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
 	virtual void PostLogin(APlayerController* NewPlayer) override;
+	virtual void Logout(AController* Exiting) override;
 	//~ End AGameMode interface
+
+	// Called when a client has finished streaming in the preload assets
+	void PlayerPreloadComplete(APlayerController* PlayerController);
+
+	const TArray<FSoftObjectPath>& GetPreloadAssets() const { return PreloadAssets; }
+
+	const FString& GetTravelMap() const { return TravelMap; }
+
+private:
+	// Players needed to start the match. Can be overridden with ?MinPlayers=N
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	int32 MinPlayers = 2;
+
+	// Seconds after the first player joins before the match starts with fewer than MinPlayers. 0 to wait forever. Can be overridden with ?LobbyTimeout=N
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	float LobbyTimeout = 0.f;
+
+	// Map to travel to
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby")
+	FString TravelMap = TEXT("/Game/Maps/BlasterMap");
+
+	// Match type advertised by the session a dedicated server creates. Can be overridden with ?MatchType=Name
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby|Dedicated Server")
+	FString MatchType = TEXT("FreeForAll");
+
+	// Assets streamed in on the server and every client before travelling
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby|Preload")
+	TArray<FSoftObjectPath> PreloadAssets;
+
+	// Longest time to wait for clients to finish preloading before travelling anyway
+	UPROPERTY(EditDefaultsOnly, Category = "Lobby|Preload")
+	float PreloadTimeout = 10.f;
+
+	FTimerHandle LobbyTimer;
+	FTimerHandle PreloadTimer;
+
+	bool bPreloadStarted = false;
+	bool bServerPreloadComplete = false;
+
+	// Set once ServerTravel has been called, so a late preload report, logout or the preload timeout can't travel again
+	bool bTravelling = false;
+
+	// Players that have not yet reported their preload as complete
+	TSet<TWeakObjectPtr<APlayerController>> PendingPreloadPlayers;
+
+	void LobbyTimeoutExpired();
+
+	// A dedicated server has no menu to host from, so the lobby creates the session itself
+	void CreateDedicatedServerSession();
+
+	// Start streaming the preload assets on the server and all clients
+	void BeginPreload();
+
+	// Ask a client to preload, or count it as done if it cannot
+	void RequestClientPreload(APlayerController* PlayerController);
+
+	void ServerPreloadComplete();
+
+	// Travel once the server and every client are ready
+	void TryTravel();
+
+	void TravelToMatch();
 };
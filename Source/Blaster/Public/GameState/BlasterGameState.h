@@ -0,0 +1,154 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/GameState.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "BlasterGameState.generated.h"
+
+class ABlasterGameState;
+class APlayerState;
+
+/**
+ * One player's row of the scoreboard
+ */
+USTRUCT()
+struct FBlasterScoreboardEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 PlayerId = INDEX_NONE;
+
+	UPROPERTY()
+	int32 Kills = 0;
+
+	UPROPERTY()
+	int32 Deaths = 0;
+
+	// Ping in milliseconds divided by 4, as APlayerState::GetCompressedPing
+	UPROPERTY()
+	uint8 CompressedPing = 0;
+
+	// Eliminations since the player was last eliminated
+	UPROPERTY()
+	int32 Streak = 0;
+
+	void PreReplicatedRemove(const struct FBlasterScoreboard& InArraySerializer);
+	void PostReplicatedAdd(const struct FBlasterScoreboard& InArraySerializer);
+	void PostReplicatedChange(const struct FBlasterScoreboard& InArraySerializer);
+};
+
+/**
+ * Scoreboard of every player, replicated as deltas of the changed rows only
+ */
+USTRUCT()
+struct FBlasterScoreboard : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FBlasterScoreboardEntry> Entries;
+
+	// Game state notified of replicated changes
+	UPROPERTY(NotReplicated)
+	TObjectPtr<ABlasterGameState> Owner;
+
+	FBlasterScoreboardEntry* FindEntry(int32 PlayerId);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FBlasterScoreboardEntry, FBlasterScoreboard>(Entries, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FBlasterScoreboard> : public TStructOpsTypeTraitsBase2<FBlasterScoreboard>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true
+	};
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnScoreboardChanged, int32 /* PlayerId */);
+
+/**
+ * GameState holding the replicated scoreboard and a leaderboard kept sorted as rows change
+ */
+UCLASS()
+class BLASTER_API ABlasterGameState : public AGameState
+{
+	GENERATED_BODY()
+
+public:
+	ABlasterGameState();
+
+	//~ Begin AGameState interface
+public:
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+	virtual void RemovePlayerState(APlayerState* PlayerState) override;
+protected:
+	virtual void BeginPlay() override;
+	virtual void OnRep_MatchState() override;
+	//~ End AGameState interface
+
+public:
+	// Server-side scoreboard row creation, once the player state has its player id
+	void AddScoreboardEntry(const APlayerState* PlayerState);
+
+	// Server-side scoreboard update for an elimination. AttackerPlayerState may be null or the victim
+	void RecordElimination(const APlayerState* AttackerPlayerState, const APlayerState* VictimPlayerState);
+
+	// Scoreboard rows sorted by kills, then deaths, then player id
+	const TArray<FBlasterScoreboardEntry>& GetLeaderboard() const { return Leaderboard; }
+
+	// Server-side start of a match phase, replicated once per phase. StartTime is in server world time
+	void SetMatchPhase(float StartTime, float Duration);
+
+	// Seconds left in the current match phase at the given server time
+	float GetMatchPhaseTimeRemaining(float ServerTime) const { return PhaseStartTime + PhaseDuration - ServerTime; }
+
+	// Broadcast on the server and clients whenever a row is added, changed or removed
+	FOnScoreboardChanged OnScoreboardChanged;
+
+	// Called by the scoreboard when a row was added or changed by replication
+	void OnScoreboardEntryChanged(const FBlasterScoreboardEntry& Entry);
+
+	// Called by the scoreboard when a row is about to be removed by replication
+	void OnScoreboardEntryRemoved(const FBlasterScoreboardEntry& Entry);
+
+private:
+	UPROPERTY(Replicated)
+	FBlasterScoreboard Scoreboard;
+
+	// Sorted copy of the scoreboard rows, updated one row at a time
+	TArray<FBlasterScoreboardEntry> Leaderboard;
+
+	// Move a row to its sorted position in the leaderboard
+	void UpdateLeaderboardEntry(const FBlasterScoreboardEntry& Entry);
+
+	void RemoveLeaderboardEntry(int32 PlayerId);
+
+	// Mark a row changed on the server and update the local leaderboard
+	void MarkEntryDirty(FBlasterScoreboardEntry& Entry);
+
+	/* Begin section: Match phase */
+	UPROPERTY(Replicated)
+	float PhaseStartTime = 0.f;
+
+	UPROPERTY(Replicated)
+	float PhaseDuration = 0.f;
+	/* End section: Match phase */
+
+	/* Begin section: Ping updates */
+	FTimerHandle PingUpdateTimer;
+
+	// Seconds between ping refreshes of the scoreboard
+	UPROPERTY(EditDefaultsOnly, Category = "Scoreboard")
+	float PingUpdateInterval = 2.f;
+
+	void UpdatePings();
+	/* End section: Ping updates */
+};
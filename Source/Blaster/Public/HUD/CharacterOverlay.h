@@ -35,4 +35,10 @@ public:
 
 	UPROPERTY(meta = (BindWidget))
 	UTextBlock* CarriedAmmoAmount;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* MatchCountdownText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* MatchStateText;
 };
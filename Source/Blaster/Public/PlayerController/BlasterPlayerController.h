@@ -19,6 +19,9 @@ class BLASTER_API ABlasterPlayerController : public APlayerController
 	//~ Begin APlayerController interface
 public:
 	virtual void OnPossess(APawn* InPawn) override;
+	virtual void AcknowledgePossession(APawn* P) override;
+	virtual void ReceivedPlayer() override;
+	virtual void Tick(float DeltaTime) override;
 protected:
 	virtual void BeginPlay() override;
 	//~ End APlayerController interface
@@ -30,8 +33,67 @@ public:
 	void SetHUDDeaths(int Deaths);
 	void SetHUDWeaponAmmo(int32 Ammo);
 	void SetHUDCarriedAmmo(int32 Ammo);
+	void SetHUDMatchCountdown(int32 SecondsRemaining);
+	void SetHUDMatchState(FName MatchState);
+
+	// Called on local controllers when the replicated match state changes
+	void OnMatchStateSet(FName MatchState);
+
+	// Return the server's world time, estimated from time sync round trips on clients
+	float GetServerTime() const;
+
+protected:
+	/* Begin section: Server time sync */
+	// Request the server time, passing the client time of the request
+	UFUNCTION(Server, Reliable)
+	void ServerRequestServerTime(float TimeOfClientRequest);
+
+	// Report the server time in response to ServerRequestServerTime
+	UFUNCTION(Client, Reliable)
+	void ClientReportServerTime(float TimeOfClientRequest, float TimeServerReceivedClientRequest);
+	/* End section: Server time sync */
+
+public:
+	/* Begin section: Travel preload */
+	// Stream in assets before the lobby travels to the match map
+	UFUNCTION(Client, Reliable)
+	void ClientPreloadAssets(const TArray<FSoftObjectPath>& Assets, const FString& DestinationMapPackage);
+
+	UFUNCTION(Server, Reliable)
+	void ServerReportPreloadComplete();
+	/* End section: Travel preload */
 
 private:
 	UPROPERTY()
 	ABlasterHUD* BlasterHUD;
+
+	/* Begin section: Server time sync */
+	// Seconds between time sync round trips
+	UPROPERTY(EditDefaultsOnly, Category = "Time Sync")
+	float TimeSyncFrequency = 5.f;
+
+	struct FTimeSyncSample
+	{
+		float RoundTripTime;
+		float ClientServerDelta;
+	};
+
+	// Recent samples. The one with the shortest round trip gives the offset, since its half round trip estimate is the tightest
+	static constexpr int32 MaxTimeSyncSamples = 5;
+	TArray<FTimeSyncSample, TInlineAllocator<MaxTimeSyncSamples>> TimeSyncSamples;
+
+	// Server time minus client time
+	float ClientServerDelta = 0.f;
+
+	FTimerHandle TimeSyncTimer;
+
+	void RequestServerTime();
+	/* End section: Server time sync */
+
+	// Last countdown second shown on the HUD, to only update the text when it changes
+	int32 LastCountdownSeconds = INDEX_NONE;
+
+	void UpdateHUDMatchCountdown();
+
+	void ClientPreloadComplete();
 };
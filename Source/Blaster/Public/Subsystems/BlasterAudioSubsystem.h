@@ -0,0 +1,53 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BlasterAudioSubsystem.generated.h"
+
+class USoundBase;
+class USoundConcurrency;
+
+UENUM()
+enum class EBlasterSoundCategory : uint8
+{
+	EBSC_Impact UMETA(DisplayName = "Impact"),
+	EBSC_Casing UMETA(DisplayName = "Casing"),
+	EBSC_Gunfire UMETA(DisplayName = "Gunfire"),
+
+	EBSC_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/**
+ * Plays Blaster one-shot sounds through a concurrency group per category.
+ * Sounds that would be inaudible to every listener are never started and each category has a per-frame spawn cap.
+ */
+UCLASS()
+class BLASTER_API UBlasterAudioSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UWorldSubsystem interface
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UWorldSubsystem interface
+
+public:
+	// Play a sound at a location if the category budget allows it and a listener can hear it
+	static void PlaySoundAtLocation(const UObject* WorldContextObject, USoundBase* Sound, const FVector& Location, EBlasterSoundCategory Category);
+
+private:
+	// Return true and consume budget if a sound of the category may start this frame
+	bool ConsumeSpawnBudget(EBlasterSoundCategory Category);
+
+	// One concurrency group per category, indexed by EBlasterSoundCategory
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<USoundConcurrency>> CategoryConcurrency;
+
+	int32 SpawnsThisFrame[static_cast<int32>(EBlasterSoundCategory::EBSC_MAX)] = {};
+
+	uint64 SpawnBudgetFrame = 0;
+};
@@ -0,0 +1,94 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Blaster/BlasterTypes/HitRegion.h"
+#include "UObject/ObjectKey.h"
+#include "BlasterDamageSubsystem.generated.h"
+
+class ABlasterCharacter;
+class UDamageType;
+class USkeletalMesh;
+
+/**
+ * Damage queued on the server until the end of the frame
+ */
+USTRUCT()
+struct FBlasterPendingDamage
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TObjectPtr<AActor> DamagedActor;
+
+	UPROPERTY()
+	TObjectPtr<AController> EventInstigator;
+
+	UPROPERTY()
+	TObjectPtr<AActor> DamageCauser;
+
+	UPROPERTY()
+	TSubclassOf<UDamageType> DamageTypeClass;
+
+	float BaseDamage = 0.f;
+
+	bool bIsPointDamage = false;
+	FVector HitFromDirection = FVector::ZeroVector;
+	FHitResult HitInfo;
+
+	// Stable id used to order victims independently of queue order
+	int32 VictimKey = 0;
+
+	// Order in which the hit was queued this frame
+	int32 Sequence = 0;
+};
+
+/**
+ * Collects damage dealt on the server during a frame and applies it once per victim at the end of the frame.
+ * Hits on a victim are resolved in the order they were queued. Hits after the lethal one are dropped, and the lethal hit's instigator gets the kill.
+ */
+UCLASS()
+class BLASTER_API UBlasterDamageSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UTickableWorldSubsystem interface
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UTickableWorldSubsystem interface
+
+public:
+	// Queue damage to be applied at the end of the frame. Falls back to applying it immediately if there is no damage subsystem
+	static void QueueDamage(AActor* DamagedActor, float BaseDamage, AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass);
+
+	// Queue point damage, scaled by the hit region multiplier when the victim is a Blaster character
+	static void QueuePointDamage(AActor* DamagedActor, float BaseDamage, const FVector& HitFromDirection, const FHitResult& HitInfo, AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass);
+
+	// Return the region of a Blaster character whose mesh was struck at a bone, using a lookup table built once per skeletal mesh
+	static EHitRegion GetHitRegion(const UPrimitiveComponent* HitComponent, FName BoneName);
+
+	// Apply all queued damage now
+	void FlushDamage();
+
+private:
+	// Strong references, since a projectile causing damage destroys itself before the damage is applied at the end of the frame
+	UPROPERTY(Transient)
+	TArray<FBlasterPendingDamage> PendingDamage;
+
+	FBlasterPendingDamage* AddPendingDamage(AActor* DamagedActor, float BaseDamage, AController* EventInstigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass);
+
+	// Hit region of every bone, per skeletal mesh
+	TMap<TObjectKey<USkeletalMesh>, TArray<EHitRegion>> HitRegionTables;
+
+	const TArray<EHitRegion>& FindOrBuildHitRegionTable(const USkeletalMesh* SkeletalMesh, const ABlasterCharacter* Character);
+
+	// Apply the damage of one victim's hits, PendingDamage[First, Last)
+	void ResolveVictim(int32 First, int32 Last);
+
+	static int32 GetVictimKey(const AActor* DamagedActor);
+};
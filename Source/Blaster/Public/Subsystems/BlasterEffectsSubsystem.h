@@ -0,0 +1,46 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "BlasterEffectsSubsystem.generated.h"
+
+class UNiagaraComponent;
+class UNiagaraSystem;
+
+/**
+ * Spawns all Blaster Niagara effects through the Niagara component pool.
+ * Caps the number of live components per system and culls effects too far from every local view.
+ * Nothing is spawned on a dedicated server.
+ */
+UCLASS()
+class BLASTER_API UBlasterEffectsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UWorldSubsystem interface
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UWorldSubsystem interface
+
+public:
+	// Spawn a one-shot effect that returns itself to the pool when it completes. May return nullptr if the effect was culled
+	static UNiagaraComponent* SpawnEffectAtLocation(const UObject* WorldContextObject, UNiagaraSystem* System, const FVector& Location, const FRotator& Rotation);
+
+	// Spawn a pooled effect attached to a component. The caller must hand it back with ReleaseEffect. May return nullptr if the effect was culled
+	static UNiagaraComponent* SpawnEffectAttached(UNiagaraSystem* System, USceneComponent* AttachToComponent, const FVector& Location, const FRotator& Rotation);
+
+	// Detach an effect spawned with SpawnEffectAttached, let it finish and return it to the pool
+	static void ReleaseEffect(UNiagaraComponent* EffectComponent);
+
+private:
+	// Return true if an effect of this system may be spawned at the location
+	bool CanSpawnEffect(const UNiagaraSystem* System, const FVector& Location);
+
+	void TrackEffect(const UNiagaraSystem* System, UNiagaraComponent* EffectComponent);
+
+	// Live components per system, pruned lazily when a new effect of the same system is requested
+	TMap<TObjectKey<UNiagaraSystem>, TArray<TWeakObjectPtr<UNiagaraComponent>>> ActiveEffects;
+};
@@ -0,0 +1,42 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Blaster/BlasterTypes/GameplayEvent.h"
+#include "BlasterEventLogSubsystem.generated.h"
+
+class FBlasterEventLogWriter;
+
+/**
+ * Binary log of server-side gameplay events (fires, hits, damage, eliminations, respawns, equips and reloads).
+ * Events are pushed into a lock-free ring buffer on the game thread and written to Saved/EventLogs by a background thread,
+ * so logging never waits on disk. Enabled with blaster.EventLog 1 from the next map, converted to CSV with the BlasterEventLogToCSV commandlet.
+ */
+UCLASS()
+class BLASTER_API UBlasterEventLogSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UWorldSubsystem interface
+public:
+	virtual void Deinitialize() override;
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UWorldSubsystem interface
+
+public:
+	// Log an event on the server. PlayerActor and OtherPlayerActor may be a pawn, controller or player state
+	static void Record(const UObject* WorldContextObject, EBlasterGameplayEvent Type, const AActor* PlayerActor, const AActor* OtherPlayerActor = nullptr, float Value = 0.f, const FVector& Location = FVector::ZeroVector, uint8 Detail = 0);
+
+	// Return the PlayerId of a pawn, controller or player state, or INDEX_NONE
+	static int32 GetPlayerId(const AActor* PlayerActor);
+
+private:
+	void Push(const FBlasterGameplayEvent& Event);
+
+	// Started when the world begins play with logging on, so matches without logging create no file
+	TSharedPtr<FBlasterEventLogWriter> Writer;
+};
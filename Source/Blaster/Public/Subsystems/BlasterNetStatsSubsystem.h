@@ -0,0 +1,143 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/CoreNet.h"
+#include "BlasterNetStatsSubsystem.generated.h"
+
+class FNetGUIDCache;
+class UNetConnection;
+class UNetDriver;
+struct FFrame;
+struct FOutParmRec;
+
+UENUM()
+enum class EBlasterNetStatKind : uint8
+{
+	EBNSK_Property UMETA(DisplayName = "Property"),
+	EBNSK_RPC UMETA(DisplayName = "RPC"),
+	EBNSK_Spawn UMETA(DisplayName = "Spawn"),
+	EBNSK_Wire UMETA(DisplayName = "Wire"),
+
+	EBNSK_MAX UMETA(DisplayName = "DefaultMAX")
+};
+
+/**
+ * Counts calls and bytes per replicated property and RPC per connection.
+ * Enabled with blaster.NetStats 1, inspected with blaster.NetStats.Top and exported to CSV at the end of a match.
+ *
+ * Nothing is reported by gameplay code. Every replicated actor and component is watched on the server, and a property is counted once per
+ * frame it changes, for the connections its replication condition sends it to, at the size the engine's serializers give its new value.
+ * Every RPC the game net driver sends is counted from its send hook, at the size of its serialized parameters: multicasts for the connections
+ * the actor is relevant to, client RPCs for the owner and server RPCs by the client that calls them. Both are payload only: bunch and packet
+ * headers and anything else the engine sends show up in the Wire rows, which are sampled from the connections' own byte counters and count
+ * packets as calls.
+ */
+UCLASS()
+class BLASTER_API UBlasterNetStatsSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UTickableWorldSubsystem interface
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UTickableWorldSubsystem interface
+
+public:
+	// Return true if net stats are being collected
+	static bool IsEnabled();
+
+	// Print the entries with the most bytes
+	void LogTopEntries(int32 Count) const;
+
+	// Write all entries to a CSV file, returning false on failure
+	bool WriteCSV(const FString& Filename) const;
+
+	void Reset();
+
+private:
+	struct FNetStatCounter
+	{
+		int64 Calls = 0;
+		int64 Bits = 0;
+	};
+
+	struct FNetStat
+	{
+		EBlasterNetStatKind Kind = EBlasterNetStatKind::EBNSK_Property;
+		FNetStatCounter Total;
+		TMap<FString, FNetStatCounter> PerConnection;
+	};
+
+	// A replicated property of a class and the condition it is sent under
+	struct FWatchedProperty
+	{
+		const FProperty* Property = nullptr;
+		int32 ArrayIndex = 0;
+		ELifetimeCondition Condition = COND_None;
+	};
+
+	// Value of a watched property as last sent
+	struct FShadowValue
+	{
+		TArray<uint8> Data;
+		int64 NumBits = 0;
+	};
+
+	// The connection counters at the last sample
+	struct FWireSample
+	{
+		int64 InBytes = 0;
+		int64 OutBytes = 0;
+		int64 InPackets = 0;
+		int64 OutPackets = 0;
+	};
+
+	void Record(FName Name, EBlasterNetStatKind Kind, const UNetConnection* Connection, int32 NumBits, int32 NumCalls = 1);
+
+	// Record traffic for the client connections a property with this condition is sent to
+	void RecordForCondition(const AActor* Actor, FName Name, EBlasterNetStatKind Kind, int32 NumBits, ELifetimeCondition Condition);
+
+	// Count the replicated properties that changed since the last frame, and the initial state of actors that appeared
+	void WatchReplicatedProperties();
+
+	// Compare an object's replicated properties against their values last frame, returning the bits of its whole state
+	int32 WatchObject(const AActor* Actor, const UObject* Object, const FNetGUIDCache* GuidCache, TMap<TObjectKey<UObject>, TArray<FShadowValue>>& PreviousValues);
+
+	const TArray<FWatchedProperty>& GetWatchedProperties(const UObject* Object);
+
+	// Sample the byte and packet counters of every connection
+	void SampleWireTraffic();
+
+	// Hook the game net driver's RPC sends, or unhook them when collection is off
+	void BindNetDriver(bool bBind);
+
+	void OnSendRPC(AActor* Actor, UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack, UObject* SubObject, bool& bBlockSendRPC);
+
+	// Return the bits the parameters of an RPC take on the wire
+	static int32 GetParameterBits(const UFunction* Function, void* Parameters, FOutParmRec* OutParms, const FNetGUIDCache* GuidCache);
+
+	static void SerializeValue(FNetBitWriter& Writer, const FProperty* Property, const void* Value, const FNetGUIDCache* GuidCache);
+
+	static FString GetConnectionName(const UNetConnection* Connection);
+
+	TMap<FName, FNetStat> Stats;
+
+	TMap<TObjectKey<UClass>, TArray<FWatchedProperty>> WatchedPropertiesByClass;
+
+	// Serialized value of each watched property last frame, per object
+	TMap<TObjectKey<UObject>, TArray<FShadowValue>> ShadowValues;
+
+	TMap<TObjectKey<UNetConnection>, FWireSample> WireSamples;
+
+	TWeakObjectPtr<UNetDriver> BoundNetDriver;
+
+	// False until the objects that existed when collection started have been seen, so they aren't counted as spawns
+	bool bWatching = false;
+};
@@ -0,0 +1,60 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "BlasterPickupSubsystem.generated.h"
+
+class ABlasterCharacter;
+class AWeapon;
+
+/**
+ * Finds the weapon each character can pick up on the server, replacing an overlap sphere per weapon.
+ * Weapons lying in the world are indexed in a spatial hash that is rebuilt at blaster.Pickup.UpdateRate, since dropped weapons simulate physics,
+ * and each character is given the nearest weapon whose pickup radius it touches.
+ */
+UCLASS()
+class BLASTER_API UBlasterPickupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UTickableWorldSubsystem interface
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+	//~ End UTickableWorldSubsystem interface
+
+public:
+	// Make a weapon available for pickup. Called on the server when a weapon is placed or dropped
+	static void RegisterPickup(AWeapon* Weapon);
+
+	// Stop offering a weapon for pickup. Called on the server when a weapon is equipped or removed
+	static void UnregisterPickup(AWeapon* Weapon);
+
+	// Rebuild the spatial hash and update the overlapping weapon of every character now
+	void UpdatePickups();
+
+private:
+	// Rebuild the cells from the current weapon locations, dropping weapons that no longer exist
+	void RebuildHash();
+
+	// Return the nearest weapon within pickup range of a character, or nullptr
+	AWeapon* FindNearestPickup(const ABlasterCharacter* Character) const;
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	TArray<TWeakObjectPtr<AWeapon>> Pickups;
+
+	// Indices into Pickups for each occupied cell
+	TMap<FIntVector, TArray<int32>> Cells;
+
+	// Twice the largest pickup radius, so a query only touches the cells next to the character
+	float CellSize = 1.f;
+
+	float LargestPickupRadius = 0.f;
+
+	float TimeSinceUpdate = 0.f;
+};
@@ -0,0 +1,42 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "BlasterPreloadSubsystem.generated.h"
+
+struct FStreamableHandle;
+
+/**
+ * Streams in assets ahead of a map travel and keeps them loaded until the destination map has loaded.
+ * Lives on the game instance so the handles survive the travel.
+ */
+UCLASS()
+class BLASTER_API UBlasterPreloadSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UGameInstanceSubsystem interface
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End UGameInstanceSubsystem interface
+
+public:
+	// Asynchronously load assets and hold them until the map with the given package name has loaded. OnComplete runs once they are loaded
+	void PreloadAssets(const TArray<FSoftObjectPath>& Assets, const FString& DestinationMapPackage, FSimpleDelegate OnComplete);
+
+	// Return true while a preload is still streaming
+	bool IsPreloading() const;
+
+private:
+	TArray<TSharedPtr<FStreamableHandle>> PreloadHandles;
+
+	// Package name of the map whose load releases the preloaded assets
+	FString DestinationMapPackage;
+
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	void ReleasePreloadedAssets();
+};
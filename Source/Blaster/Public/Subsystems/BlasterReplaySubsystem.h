@@ -0,0 +1,71 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "BlasterReplaySubsystem.generated.h"
+
+/**
+ * Records matches with the demo net driver and plays them back.
+ * With blaster.Replay.AutoRecord 1 the server records every match from its start to the cooldown.
+ * blaster.Replay.Profile plays a replay at a fixed timestep as fast as the machine allows and writes per-frame timings to a CSV,
+ * so a reported spike can be reproduced offline, e.g. headless with:
+ *
+ *   UnrealEditor Blaster.uproject -game -nullrhi -ReplayProfile=<Name> -ReplayProfileExit -trace=default
+ */
+UCLASS()
+class BLASTER_API UBlasterReplaySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UGameInstanceSubsystem interface
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End UGameInstanceSubsystem interface
+
+public:
+	// Start recording the match if auto recording is enabled. Called by the game mode when the match starts
+	static void StartMatchRecording(const UObject* WorldContextObject);
+
+	// Stop the match recording started by StartMatchRecording
+	static void StopMatchRecording(const UObject* WorldContextObject);
+
+	void StartRecording(const FString& ReplayName);
+	void StopRecording();
+
+	// Play a replay. With bProfile, play it at a fixed timestep as fast as possible and record frame timings
+	void PlayReplay(const FString& ReplayName, bool bProfile);
+
+private:
+	struct FFrameSample
+	{
+		double DemoTime;
+		float FrameMs;
+		float GameThreadMs;
+	};
+
+	bool bRecordingMatch = false;
+
+	bool bProfiling = false;
+	FString ProfiledReplayName;
+	TArray<FFrameSample> FrameSamples;
+	double LastFrameTime = 0.0;
+
+	// Timestep settings restored when profiling ends
+	bool bSavedUseFixedTimeStep = false;
+	double SavedFixedDeltaTime = 0.0;
+
+	FTSTicker::FDelegateHandle ProfileTickerHandle;
+
+	void BeginProfiling(const FString& ReplayName);
+	bool TickProfiling(float DeltaTime);
+	void EndProfiling(bool bCompleted);
+
+	// Write the frame timings to the profiling directory and log a summary
+	void WriteProfile() const;
+
+	void OnReplayPlaybackComplete(UWorld* World);
+};
@@ -0,0 +1,56 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "BlasterServerDensitySubsystem.generated.h"
+
+struct FStreamableHandle;
+enum class EForkProcessRole : uint8;
+
+/**
+ * Packs more matches onto a Linux host by running the dedicated server with -WaitAndFork.
+ * The parent loads the match assets once before forking, so every child match shares those pages copy-on-write,
+ * and each child is given a tick rate budget (blaster.Server.ForkedTickRate) with overruns reported in the log.
+ * Each child is its own process, which keeps game mode state isolated between matches.
+ */
+UCLASS()
+class BLASTER_API UBlasterServerDensitySubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UGameInstanceSubsystem interface
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End UGameInstanceSubsystem interface
+
+private:
+	// Assets held by the parent so the children inherit them already loaded
+	TSharedPtr<FStreamableHandle> SharedAssetsHandle;
+
+	FTSTicker::FDelegateHandle BudgetTickerHandle;
+
+	int32 NumFrames = 0;
+	int32 NumFramesOverBudget = 0;
+	double WorstFrameMs = 0.0;
+	double LastReportTime = 0.0;
+
+	void OnParentPreFork();
+
+	// Add an asset to share, replacing a map with its dependencies
+	static void AddSharedAsset(const FSoftObjectPath& Asset, TArray<FSoftObjectPath>& OutAssets);
+
+	// Add the assets a map hard references, without the map's own world
+	static void AddMapDependencies(FName MapPackage, TArray<FSoftObjectPath>& OutAssets);
+	void OnPostFork(EForkProcessRole Role);
+	void OnPostLoadMap(UWorld* LoadedWorld);
+
+	// Cap the server tick rate of this child
+	void ApplyTickRate(UWorld* World) const;
+
+	bool TickBudget(float DeltaTime);
+};
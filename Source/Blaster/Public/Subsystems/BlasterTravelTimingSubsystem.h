@@ -0,0 +1,52 @@
+// Copyright Peter Carsten Collins (2024)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "BlasterTravelTimingSubsystem.generated.h"
+
+struct FWorldContext;
+
+/**
+ * Records timed markers for map travel and startup, from ServerTravel to the HUD appearing.
+ * Each marker is appended to a CSV per game instance in the profiling directory and emitted as an Insights bookmark.
+ */
+UCLASS()
+class BLASTER_API UBlasterTravelTimingSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+	//~ Begin UGameInstanceSubsystem interface
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	//~ End UGameInstanceSubsystem interface
+
+public:
+	// Record a marker. With bOncePerMap, only the first marker of that name after each map load is recorded
+	static void Mark(const UObject* WorldContextObject, FName Marker, const FString& Detail = FString(), bool bOncePerMap = false);
+
+private:
+	void AddMarker(FName Marker, const FString& Detail, bool bOncePerMap);
+
+	void OnPreLoadMap(const FWorldContext& WorldContext, const FString& MapName);
+	void OnPostLoadMap(UWorld* LoadedWorld);
+	void OnSeamlessTravelStart(UWorld* World, const FString& MapName);
+	void OnSeamlessTravelTransition(UWorld* World);
+
+	// Return true if a world passed to the global map delegates belongs to this game instance
+	bool IsOwnWorld(const UWorld* World) const;
+
+	FString GetNetModeName() const;
+
+	// Time the session started, markers are relative to it
+	double SessionStartTime = 0.0;
+
+	double LastMarkerTime = 0.0;
+
+	// Markers recorded since the last map load, for bOncePerMap
+	TSet<FName> MarkersSinceMapLoad;
+
+	FString CSVFilename;
+};
@@ -6,6 +6,7 @@
 #include "GameFramework/Actor.h"
 #include "Projectile.generated.h"
 
+class AProjectileWeapon;
 class UBoxComponent;
 class UNiagaraSystem;
 class UNiagaraComponent;
@@ -34,9 +35,27 @@ protected:
 	UFUNCTION()
 	virtual void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	// Hit callback for client-side simulated projectiles, which never deal damage
+	UFUNCTION()
+	void OnCosmeticHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
 	UPROPERTY(EditAnywhere)
 	float Damage = 10.f;
 
+public:
+	// Link this projectile to a spawn event. Must be called before FinishSpawning
+	void InitializeFromSpawnEvent(AProjectileWeapon* InSpawnEventWeapon, uint16 InProjectileId, bool bInIsCosmetic);
+
+	// Move a simulated projectile to its authoritative impact location and destroy it
+	void CompleteAtImpact(const FVector& ImpactLocation);
+
+	// Initial speed of the projectile movement. Must be set before FinishSpawning
+	void SetInitialSpeed(float Speed);
+	float GetInitialSpeed() const;
+
+	uint16 GetProjectileId() const { return ProjectileId; }
+	bool IsCosmetic() const { return bIsCosmetic; }
+
 private:
 	UPROPERTY(EditAnywhere)
 	TObjectPtr<UBoxComponent> CollisionBox;
@@ -55,4 +74,12 @@ private:
 
 	UPROPERTY(EditAnywhere)
 	TObjectPtr<USoundCue> ImpactSound;
+
+	// Weapon that sent the spawn event for this projectile, if it was spawned from one
+	TWeakObjectPtr<AProjectileWeapon> SpawnEventWeapon;
+
+	uint16 ProjectileId = 0;
+
+	// True for client-side simulations of a server projectile
+	bool bIsCosmetic = false;
 };
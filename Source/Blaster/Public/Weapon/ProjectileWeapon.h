@@ -4,10 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "Weapon/Weapon.h"
+#include "Weapon/Projectile.h"
 #include "ProjectileWeapon.generated.h"
 
-class AProjectile;
-
 /**
  * Base class for weapons that fire a projectile
  */
@@ -18,12 +17,46 @@ class BLASTER_API AProjectileWeapon : public AWeapon
 
 //~ Begin AWeapon interface
 public:
-	virtual void Fire(const FVector& HitTarget) override;
+	virtual void PrepareFire(FWeaponFireParams& Params) override;
+	virtual void Fire(const FWeaponFireParams& Params) override;
 //~ End AWeapon interface
 
+	// Called on the server when a projectile spawned from a spawn event hits something
+	void NotifyProjectileImpact(uint16 ProjectileId, const FVector& ImpactLocation);
+
+	// Called on clients when a simulated projectile is destroyed
+	void ForgetSimulatedProjectile(uint16 ProjectileId, const AProjectile* Projectile);
+
+protected:
+	// Finish the simulated projectile at the authoritative impact location
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileImpact(uint16 ProjectileId, const FVector_NetQuantize& ImpactLocation);
+
 private:
+	// Work out where a shot's projectile starts and which way it goes, returning false if the weapon has no muzzle
+	bool GetProjectileSpawn(const FWeaponFireParams& Params, FVector& OutLocation, FVector& OutDirection) const;
+
+	// Simulate a projectile the server sent with a shot
+	void SpawnSimulatedProjectile(const FProjectileSpawnEvent& SpawnEvent);
+
+	// Move the spawn location along the shot by the distance a projectile covered since its sub-frame fire time, stopping short of blocking geometry
+	FVector GetSubFrameSpawnLocation(const FVector& MuzzleLocation, const FVector& Direction, float Distance) const;
+
 	// The projectile to spawn
 	UPROPERTY(EditAnywhere, Category = "Projectile Properties")
 	TSubclassOf<AProjectile> ProjectileClass;
 
+	// If true, projectiles are not replicated. The server sends a spawn event with the shot and clients simulate the projectile locally
+	UPROPERTY(EditAnywhere, Category = "Projectile Properties")
+	bool bUseSpawnEvents = true;
+
+	// Id of the next projectile spawned from a spawn event
+	uint16 NextProjectileId = 0;
+
+	// Client-side simulated projectiles waiting for their authoritative impact
+	TMap<uint16, TWeakObjectPtr<AProjectile>> SimulatedProjectiles;
+
+	// Furthest a projectile is moved forward to make up for its sub-frame fire time
+	UPROPERTY(EditAnywhere, Category = "Projectile Properties")
+	float MaxSubFrameSpawnDistance = 500.f;
 };
@@ -4,6 +4,8 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Blaster/BlasterTypes/WeaponFireParams.h"
+#include "Blaster/BlasterTypes/WeaponSpread.h"
 #include "Weapon/WeaponTypes.h"
 #include "Weapon.generated.h"
 
@@ -40,6 +42,7 @@ public:
 	virtual void OnRep_Owner() override;
 protected:
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	//~ End AActor interface
 
 public:
@@ -48,8 +51,11 @@ public:
 	// Show or hide the pickup widget
 	void ShowPickupWidget(bool bShowWidget);
 
-	// Fire this weapon
-	virtual void Fire(const FVector& HitTarget);
+	// Called on the server before a shot is multicast, to add what clients need to play it
+	virtual void PrepareFire(FWeaponFireParams& Params);
+
+	// Fire one shot from this weapon
+	virtual void Fire(const FWeaponFireParams& Params);
 
 	// Check if this weapon can fire
 	bool CanFire() const;
@@ -81,25 +87,19 @@ public:
 	// End section: Textures for the weapon's crosshairs
 
 	// Begin section: Automatic fire
+	// Seconds between shots
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	float FireDelay = 0.15f;
 
 	UPROPERTY(EditAnywhere, Category = "Combat")
 	bool bIsAutomatic = true;
 	// End section: Automatic fire
-	
-	//~ Begin overlap callbacks
-	UFUNCTION()
-	virtual void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-	UFUNCTION()
-	virtual void OnSphereEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
-	//~ End overlap callbacks
 
 private:
 	UPROPERTY(VisibleAnywhere, Category = "Weapon Properties")
 	TObjectPtr<USkeletalMeshComponent> WeaponMesh;
 
-	// Sphere for detecting overlaps with characters
+	// Sphere whose radius is the pickup range, checked by the pickup subsystem rather than by overlaps
 	UPROPERTY(VisibleAnywhere, Category = "Weapon Properties")
 	TObjectPtr<USphereComponent> AreaSphere;
 
@@ -179,11 +179,22 @@ private:
 	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
 	EWeaponType WeaponType;
 
+	// Spread of the weapon's shots and crosshairs
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties|Spread")
+	FWeaponSpreadParams SpreadParams;
+
+	// Inventory slot the weapon goes into when picked up
+	UPROPERTY(EditAnywhere, Category = "Weapon Properties")
+	EInventorySlot InventorySlot = EInventorySlot::EIS_Primary;
+
 public:
 	void SetWeaponState(EWeaponState State);
 
 	USphereComponent* GetAreaSphere() const { return AreaSphere; }
 
+	// Distance from the weapon within which a character can pick it up
+	float GetPickupRadius() const;
+
 	USkeletalMeshComponent* GetWeaponMesh() const { return WeaponMesh; }
 
 	float GetZoomedFOV() const { return ZoomedFOV; }
@@ -191,4 +202,8 @@ public:
 	float GetZoomInterpSpeed() const { return ZoomInterpSpeed; }
 
 	EWeaponType GetWeaponType() const { return WeaponType; }
+
+	EInventorySlot GetInventorySlot() const { return InventorySlot; }
+
+	const FWeaponSpreadParams& GetSpreadParams() const { return SpreadParams; }
 };
@@ -12,3 +12,12 @@ enum class EWeaponType : uint8
 
 	EWT_MAX UMETA(DisplayName = "DefaultMAX")
 };
+
+UENUM(BlueprintType)
+enum class EInventorySlot : uint8
+{
+	EIS_Primary UMETA(DisplayName = "Primary"),
+	EIS_Secondary UMETA(DisplayName = "Secondary"),
+
+	EIS_MAX UMETA(DisplayName = "DefaultMAX")
+};